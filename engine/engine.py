@@ -1,6 +1,10 @@
 import sys
 import os
 import shutil
+import json
+import random
+import struct
+import zlib
 
 
 jicedir = os.path.join(os.path.dirname(os.path.realpath(__file__)), "jice")
@@ -65,6 +69,112 @@ def new_proj(proj_dir):
     shutil.copytree(os.path.join(jicedir, "template"), proj_dir)
     print(f"Created new project in {proj_dir}")
 
+def write_png(path, width, height, rng):
+    # a random gradient, so every image differs and compresses like real art rather than noise
+    base = [rng.randrange(256) for _ in range(4)]
+    step = [rng.randrange(1, 8) for _ in range(4)]
+    rows = bytearray()
+    for y in range(height):
+        rows.append(0)  # no filter
+        for x in range(width):
+            rows += bytes([(base[0] + x * step[0]) & 255, (base[1] + y * step[1]) & 255,
+                           (base[2] + (x ^ y) * step[2]) & 255, 255])
+
+    def chunk(kind, data):
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data) & 0xffffffff)
+
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 6, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(bytes(rows))))
+        f.write(chunk(b"IEND", b""))
+
+
+def write_json(path, data_id, data):
+    with open(path, "w") as f:
+        json.dump({"engine_version": 100, "data_id": data_id, "data": data}, f, indent=4)
+
+
+def transform_attr(rng):
+    return {"type": "builtin", "id": "transform", "data": {
+        "position": [round(rng.uniform(-1, 1), 3), round(rng.uniform(-1, 1), 3), 0.0],
+        "rotation": [0.0, 0.0, 0.0],
+        "scale": [1.0, 1.0, 1.0]
+    }}
+
+
+def generate_proj(proj_dir, scenes, objects, assets, seed):
+    # A synthetic project of a given size for benchmarking jicc, the generated build and engine startup.
+    # The same arguments always produce the same project.
+    if os.path.exists(proj_dir):
+        print(f"Directory {proj_dir} already exists")
+        return
+    rng = random.Random(seed)
+    shutil.copytree(os.path.join(jicedir, "template"), proj_dir)
+    os.remove(os.path.join(proj_dir, "scenes", "Scene1.json"))
+    os.makedirs(os.path.join(proj_dir, "assets"))
+    os.makedirs(os.path.join(proj_dir, "prefabs"))
+
+    write_json(os.path.join(proj_dir, "proj.json"), 0, {
+        "id": "generated_project",
+        "name": "Generated Project",
+        "description": f"{scenes} scenes x {objects} objects x {assets} assets, seed {seed}",
+        "version": "0.0.1",
+        "author": "engine.py generate",
+        "splash_screen": {"enabled": False},
+        "content": {
+            "asset_path": "assets",
+            "script_path": "scripts",
+            "scene_path": "scenes",
+            "prefab_path": "prefabs"
+        }
+    })
+
+    images = []
+    for i in range(assets):
+        name = f"tex{i}.png"
+        size = rng.choice([64, 128, 256, 512])
+        write_png(os.path.join(proj_dir, "assets", name), size, size, rng)
+        # mostly embedded, some shipped next to the executable, like a real project
+        write_json(os.path.join(proj_dir, "assets", name + ".jmeta"), 2, {
+            "mode": "copy" if rng.random() < 0.3 else "compile",
+            "texture": {"format": "rgba8", "mipmaps": True}
+        })
+        images.append(name)
+
+    def image_attr():
+        return {"type": "builtin", "id": "image2d", "data": {"image": rng.choice(images)}} if images else None
+
+    write_json(os.path.join(proj_dir, "prefabs", "GeneratedPrefab.json"), 3, {
+        "name": "GeneratedPrefab",
+        "attributes": [a for a in [transform_attr(rng), image_attr()] if a is not None]
+    })
+
+    for s in range(scenes):
+        roots = []
+        everything = []
+        for o in range(objects):
+            if rng.random() < 0.1:
+                obj = {"id": f"Obj{o}", "prefab": "GeneratedPrefab", "attributes": [], "children": []}
+            else:
+                attrs = [a for a in [transform_attr(rng), image_attr()] if a is not None]
+                if rng.random() < 0.2:
+                    attrs.append({"type": "script", "location": "FirstScript", "data": {}})
+                obj = {"id": f"Obj{o}", "attributes": attrs, "children": []}
+            # about half the objects are nested under one made earlier, at any depth
+            if everything and rng.random() < 0.5:
+                rng.choice(everything)["children"].append(obj)
+            else:
+                roots.append(obj)
+            everything.append(obj)
+        write_json(os.path.join(proj_dir, "scenes", f"Scene{s}.json"), 1, {
+            "name": f"Scene{s}",
+            "3d": False,
+            "content": roots
+        })
+    print(f"Generated {scenes} scenes x {objects} objects x {assets} assets in {proj_dir}")
+
+
 if __name__ == '__main__':
 
     if len(sys.argv) < 3:
@@ -74,6 +184,7 @@ if __name__ == '__main__':
         print("jice editor <directory>") # compile for the editor mode
         print("jice clean <directory>")
         print("jice new <directory>")
+        print("jice generate <directory> [scenes=10] [objects=100] [assets=50] [seed=1]") # benchmark project
         sys.exit(1)
     if sys.argv[1].lower() == "compile":
         compile_proj(sys.argv[2], len(sys.argv) > 3 and (sys.argv[3].lower() == "debug" or sys.argv[3].lower() == "d" or sys.argv[3].lower() == "dbg" or sys.argv[3].lower() == "true"))
@@ -83,4 +194,8 @@ if __name__ == '__main__':
         new_proj(sys.argv[2])
     elif sys.argv[1].lower() == "editor":
         editor_proj(sys.argv[2])
+    elif sys.argv[1].lower() == "generate":
+        sizes = [int(a) for a in sys.argv[3:7]]
+        sizes += [10, 100, 50, 1][len(sizes):]
+        generate_proj(sys.argv[2], *sizes)
 
@@ -20,20 +20,9 @@ namespace jice {
             2, 3, 0
     };
 
-    Image2d::Image2d(AttributeData data, bool create_buffer, const std::string& shader) : AttributeInterface(data) {
-        image = "";
-        this->shader = shader;
-        if (data.find("image") != data.end()) {
-            if (data["image"].type == AttrDataType::String) {
-                image = data["image"].s;
-            } else {
-                std::cout << "Invalid data type for image" << std::endl;
-            }
-        } else {
-            std::cout << "Image not found" << std::endl;
-        }
-        if (create_buffer) {
-
+    // every Image2d draws the same quad, so all of them share one set of GL buffers
+    static EogllBufferObject imageBuffer() {
+        static EogllBufferObject buffer = [] {
             unsigned int vao = eogllGenVertexArray();
             unsigned int vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, sizeof(image_vertices), image_vertices,
                                               GL_STATIC_DRAW);
@@ -43,7 +32,25 @@ namespace jice {
             eogllAddAttribute(&builder, GL_FLOAT, 3);
             eogllAddAttribute(&builder, GL_FLOAT, 2);
             eogllBuildAttributes(&builder, vao);
-            this->b_obj = eogllCreateBufferObject(vao, vbo, ebo, sizeof(image_indices), GL_UNSIGNED_INT);
+            return eogllCreateBufferObject(vao, vbo, ebo, sizeof(image_indices), GL_UNSIGNED_INT);
+        }();
+        return buffer;
+    }
+
+    Image2d::Image2d(const LayeredAttributeData &data, bool create_buffer, const std::string& shader) : AttributeInterface(data) {
+        image = "";
+        this->shader = shader;
+        if (const AttrData *img = data.find("image")) {
+            if (img->type == AttrDataType::String) {
+                image = img->s;
+            } else {
+                std::cout << "Invalid data type for image" << std::endl;
+            }
+        } else {
+            std::cout << "Image not found" << std::endl;
+        }
+        if (create_buffer) {
+            this->b_obj = imageBuffer();
         }
     }
 
@@ -70,4 +77,14 @@ namespace jice {
         return {Transform::COMPONENT_NAME};
     }
 
+    void Image2d::saveState(StateWriter &out) {
+        out.writeString(image);
+        out.writeString(shader);
+    }
+
+    void Image2d::loadState(StateReader &in) {
+        in.readString(image);
+        in.readString(shader);
+    }
+
 }
\ No newline at end of file
@@ -12,11 +12,15 @@ namespace jice {
         EogllBufferObject b_obj{};
         std::string shader;
 
-        explicit Image2d(AttributeData data, bool create_buffer = true, const std::string& shader="default_3f2f_pt");
+        explicit Image2d(const LayeredAttributeData &data, bool create_buffer = true, const std::string& shader="default_3f2f_pt");
 
         void Update(Engine *e, GameObject *obj) override;
 
         std::vector<std::string> getDependencies() override;
+
+        void saveState(StateWriter &out) override;
+
+        void loadState(StateReader &in) override;
     };
 
 }
\ No newline at end of file
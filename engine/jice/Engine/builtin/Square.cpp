@@ -19,9 +19,9 @@ namespace jice {
             2, 3, 0
     };
 
-    Square::Square(AttributeData data, bool create_buffer, const std::string& shader) : AttributeInterface(data) {
-        this->shader = shader;
-        if (create_buffer) {
+    // shared by every Square, see Image2d
+    static EogllBufferObject squareBuffer() {
+        static EogllBufferObject buffer = [] {
             unsigned int vao = eogllGenVertexArray();
             unsigned int vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, sizeof(square_vertices), square_vertices,
                                               GL_STATIC_DRAW);
@@ -30,7 +30,15 @@ namespace jice {
             EogllAttribBuilder builder = eogllCreateAttribBuilder();
             eogllAddAttribute(&builder, GL_FLOAT, 3);
             eogllBuildAttributes(&builder, vao);
-            this->b_obj = eogllCreateBufferObject(vao, vbo, ebo, sizeof(square_indices), GL_UNSIGNED_INT);
+            return eogllCreateBufferObject(vao, vbo, ebo, sizeof(square_indices), GL_UNSIGNED_INT);
+        }();
+        return buffer;
+    }
+
+    Square::Square(const LayeredAttributeData &data, bool create_buffer, const std::string& shader) : AttributeInterface(data) {
+        this->shader = shader;
+        if (create_buffer) {
+            this->b_obj = squareBuffer();
         }
     }
 
@@ -54,5 +62,13 @@ namespace jice {
         return {Transform::COMPONENT_NAME};
     }
 
+    void Square::saveState(StateWriter &out) {
+        out.writeString(shader);
+    }
+
+    void Square::loadState(StateReader &in) {
+        in.readString(shader);
+    }
+
 
 }
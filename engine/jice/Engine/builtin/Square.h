@@ -10,10 +10,14 @@ namespace jice {
         EogllBufferObject b_obj{};
         std::string shader;
 
-        explicit Square(AttributeData data, bool create_buffer = true, const std::string& shader="default_3f_p");
+        explicit Square(const LayeredAttributeData &data, bool create_buffer = true, const std::string& shader="default_3f_p");
 
         void Update(Engine *e, GameObject *obj) override;
 
         std::vector<std::string> getDependencies() override;
+
+        void saveState(StateWriter &out) override;
+
+        void loadState(StateReader &in) override;
     };
 }
\ No newline at end of file
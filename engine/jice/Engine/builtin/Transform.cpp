@@ -5,41 +5,27 @@ namespace jice {
 
     const std::string Transform::COMPONENT_NAME = "transform";
 
-    Transform::Transform(AttributeData data) : AttributeInterface(data) {
+    static void readVec3(const LayeredAttributeData &data, const std::string &key, Vec3 &out) {
+        const AttrData *value = data.find(key);
+        if (value == nullptr) {
+            return;
+        }
+        if (value->type == AttrDataType::VecF) {
+            out = Vec3(value->vecF[0], value->vecF[1], value->vecF[2]);
+        } else if (value->type == AttrDataType::VecI) {
+            out = Vec3((float) value->vecI[0], (float) value->vecI[1], (float) value->vecI[2]);
+        } else {
+            std::cout << "Invalid data type for " << key << std::endl;
+        }
+    }
+
+    Transform::Transform(const LayeredAttributeData &data) : AttributeInterface(data) {
         position = Vec3(0, 0, 0);
         rotation = Vec3(0, 0, 0);
         scale = Vec3(1, 1, 1);
-        if (data.find("position") != data.end()) {
-            if (data["position"].type == AttrDataType::VecF) {
-                position = Vec3(data["position"].vecF[0], data["position"].vecF[1], data["position"].vecF[2]);
-            } else if (data["position"].type == AttrDataType::VecI) {
-                position = Vec3((float) data["position"].vecI[0], (float) data["position"].vecI[1],
-                                (float) data["position"].vecI[2]);
-            } else {
-                std::cout << "Invalid data type for position" << std::endl;
-
-            }
-        }
-        if (data.find("rotation") != data.end()) {
-            if (data["rotation"].type == AttrDataType::VecF) {
-                rotation = Vec3(data["rotation"].vecF[0], data["rotation"].vecF[1], data["rotation"].vecF[2]);
-            } else if (data["rotation"].type == AttrDataType::VecI) {
-                rotation = Vec3((float) data["rotation"].vecI[0], (float) data["rotation"].vecI[1],
-                                (float) data["rotation"].vecI[2]);
-            } else {
-                std::cout << "Invalid data type for rotation" << std::endl;
-            }
-        }
-        if (data.find("scale") != data.end()) {
-            if (data["scale"].type == AttrDataType::VecF) {
-                scale = Vec3(data["scale"].vecF[0], data["scale"].vecF[1], data["scale"].vecF[2]);
-            } else if (data["scale"].type == AttrDataType::VecI) {
-                scale = Vec3((float) data["scale"].vecI[0], (float) data["scale"].vecI[1],
-                             (float) data["scale"].vecI[2]);
-            } else {
-                std::cout << "Invalid data type for scale" << std::endl;
-            }
-        }
+        readVec3(data, "position", position);
+        readVec3(data, "rotation", rotation);
+        readVec3(data, "scale", scale);
     }
 
     void Transform::Update(Engine *e, GameObject *obj) {
@@ -56,6 +42,18 @@ namespace jice {
         return {};
     }
 
+    void Transform::saveState(StateWriter &out) {
+        out.write(position);
+        out.write(rotation);
+        out.write(scale);
+    }
+
+    void Transform::loadState(StateReader &in) {
+        in.read(position);
+        in.read(rotation);
+        in.read(scale);
+    }
+
     EogllModel Transform::toModel() {
         EogllModel model;
         model.pos[0] = position.x;
@@ -13,12 +13,16 @@ namespace jice {
         Vec3 rotation;
         Vec3 scale;
 
-        explicit Transform(AttributeData data);
+        explicit Transform(const LayeredAttributeData &data);
 
         void Update(Engine *e, GameObject *obj) override;
 
         std::vector<std::string> getDependencies() override;
 
+        void saveState(StateWriter &out) override;
+
+        void loadState(StateReader &in) override;
+
         friend std::ostream &operator<<(std::ostream &os, const Transform &transform);
 
         EogllModel toModel();
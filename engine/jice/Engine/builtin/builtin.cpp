@@ -2,7 +2,7 @@
 #include "Engine/internal/Engine.h"
 
 namespace jice {
-    AttributeInterface *createBuiltinAttr(Engine *e, const std::string &id, const AttributeData &data) {
+    AttributeInterface *createBuiltinAttr(Engine *e, const std::string &id, const LayeredAttributeData &data) {
         if (id == Transform::COMPONENT_NAME) {
             return new Transform(data);
         } else if (id == Image2d::COMPONENT_NAME) {
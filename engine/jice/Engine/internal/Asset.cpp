@@ -1,6 +1,6 @@
 #include "Asset.h"
+#include "Engine/util/FileMap.h"
 
-#include <fstream>
 #include <iostream>
 
 namespace jice {
@@ -8,28 +8,42 @@ namespace jice {
     Asset::Asset() = default;
 
     Asset::Asset(std::vector<uint8_t> data) {
-        this->data = std::move(data);
+        auto owner = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+        size = owner->size();
+        // aliasing constructor: points at the vector's contents but keeps the vector alive
+        bytes = std::shared_ptr<const uint8_t>(owner, owner->data());
     }
 
-    std::vector<uint8_t> Asset::getData() const {
-        return data;
+    Asset::Asset(std::shared_ptr<const uint8_t> bytes, size_t size) {
+        this->bytes = std::move(bytes);
+        this->size = size;
+    }
+
+    AssetSpan Asset::getData() const {
+        return {bytes.get(), size};
     }
 
     size_t Asset::getSize() const {
-        return data.size();
+        return size;
+    }
+
+    bool Asset::empty() const {
+        return size == 0;
     }
 
     Asset CompiledAsset(const uint8_t *data, size_t length) {
-        return Asset(std::vector<uint8_t>(data, data + length));
+        // static data, so there is nothing to free
+        return {std::shared_ptr<const uint8_t>(data, [](const uint8_t *) {}), length};
     }
 
     Asset CopiedAsset(const std::string &path) {
-        std::ifstream file("assets/" + path, std::ios::binary);
-        if (!file.is_open()) {
+        size_t size = 0;
+        std::shared_ptr<const uint8_t> data = mapFile("assets/" + path, size);
+        if (data == nullptr) {
             std::cerr << "Failed to open file: " << path << std::endl;
+            return {};
         }
-        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-        return Asset(data);
+        return {std::move(data), size};
     }
 
-}
\ No newline at end of file
+}
@@ -2,11 +2,41 @@
 #include <string>
 #include <cstdint>
 #include <vector>
+#include <memory>
 
 namespace jice {
+
+    // read-only view of an asset's bytes, same shape as std::span<const uint8_t> (the engine is still C++17)
+    class AssetSpan {
+    private:
+        const uint8_t *ptr = nullptr;
+        size_t len = 0;
+
+    public:
+        AssetSpan() = default;
+
+        AssetSpan(const uint8_t *data, size_t size) : ptr(data), len(size) {}
+
+        [[nodiscard]] const uint8_t *data() const { return ptr; }
+
+        [[nodiscard]] size_t size() const { return len; }
+
+        [[nodiscard]] bool empty() const { return len == 0; }
+
+        [[nodiscard]] const uint8_t *begin() const { return ptr; }
+
+        [[nodiscard]] const uint8_t *end() const { return ptr + len; }
+
+        const uint8_t &operator[](size_t i) const { return ptr[i]; }
+    };
+
+    // A cheap handle to immutable asset data. Copies share the same buffer, and the buffer's owner
+    // (a heap vector, a file mapping, or nothing at all for data embedded in the executable) is
+    // released when the last handle goes away.
     class Asset {
     private:
-        std::vector<uint8_t> data; // we don't want this to be modifiable from outside
+        std::shared_ptr<const uint8_t> bytes; // we don't want this to be modifiable from outside
+        size_t size = 0;
 
     public:
 
@@ -14,13 +44,30 @@ namespace jice {
 
         explicit Asset(std::vector<uint8_t> data);
 
-        [[nodiscard]] std::vector<uint8_t> getData() const;
+        Asset(std::shared_ptr<const uint8_t> bytes, size_t size);
+
+        [[nodiscard]] AssetSpan getData() const;
 
         [[nodiscard]] size_t getSize() const;
+
+        [[nodiscard]] bool empty() const;
+    };
+
+    // Where an asset can be found, registered in place of the asset itself so nothing is touched until
+    // it is first used. Exactly one of data, path and shares is set.
+    struct AssetDescriptor {
+        const char *name;
+        const uint8_t *data; // embedded bytes
+        const size_t *length; // a pointer, so a table of these needs no dynamic initialization
+        const char *path; // file under assets/
+        uint64_t size; // of the file, for path
+        const char *shares; // another asset with the same bytes
     };
 
+    // points straight at the embedded array, nothing is copied
     Asset CompiledAsset(const uint8_t *data, size_t length);
 
+    // memory maps assets/<path>
     Asset CopiedAsset(const std::string &path);
 
-}
\ No newline at end of file
+}
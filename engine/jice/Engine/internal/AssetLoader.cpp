@@ -0,0 +1,138 @@
+#include "AssetLoader.h"
+#include "Engine/util/Compression.h"
+
+#include <chrono>
+
+namespace jice {
+
+    AssetLoader::AssetLoader(unsigned int threads) {
+        if (threads == 0) {
+            unsigned int cores = std::thread::hardware_concurrency();
+            threads = cores > 1 ? cores - 1 : 1;
+        }
+        for (unsigned int i = 0; i < threads; i++) {
+            workers.emplace_back(&AssetLoader::workerLoop, this);
+        }
+    }
+
+    AssetLoader::~AssetLoader() {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stopping = true;
+        }
+        jobCv.notify_all();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+    void AssetLoader::workerLoop() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobCv.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping) {
+                    return;
+                }
+                job = jobs.top();
+                jobs.pop();
+            }
+            job.fn();
+        }
+    }
+
+    void AssetLoader::submit(std::function<void()> job, LoadPriority priority) {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobs.push({priority, nextSeq++, std::move(job)});
+        }
+        jobCv.notify_one();
+    }
+
+    void AssetLoader::submit(std::function<void()> job, std::function<void()> done, LoadPriority priority) {
+        outstanding++;
+        submit([this, job = std::move(job), done = std::move(done)] {
+            job();
+            std::lock_guard<std::mutex> lock(readyMutex);
+            finished.push_back(done);
+        }, priority);
+    }
+
+    void AssetLoader::finishJobs() {
+        while (true) {
+            std::function<void()> done;
+            {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                if (finished.empty()) {
+                    break;
+                }
+                done = std::move(finished.front());
+                finished.pop_front();
+            }
+            done();
+            outstanding--;
+        }
+    }
+
+    LoadHandle AssetLoader::loadTexture(const std::string &name, Asset asset, LoadPriority priority, Texture *target) {
+        auto request = std::make_shared<LoadRequest>();
+        request->name = name;
+        request->asset = std::move(asset);
+        request->target = target;
+        outstanding++;
+        submit([this, request] {
+            if (request->state == LoadState::Pending) {
+                Asset data = request->asset;
+                if (isCompressed(data.getData()) && !decompressAsset(request->asset, data, request->error)) {
+                    request->state = LoadState::Failed;
+                } else if (!decodeImage(data, request->image, request->error)) {
+                    request->state = LoadState::Failed;
+                }
+            }
+            // failed and cancelled requests still go through uploadReady so the caller hears about them
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.push_back(request);
+        }, priority);
+        return LoadHandle(request);
+    }
+
+    std::vector<std::shared_ptr<LoadRequest>> AssetLoader::uploadReady(double budgetMs) {
+        std::vector<std::shared_ptr<LoadRequest>> finished;
+        auto start = std::chrono::high_resolution_clock::now();
+        while (true) {
+            std::shared_ptr<LoadRequest> request;
+            {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                if (ready.empty()) {
+                    break;
+                }
+                request = ready.front();
+                ready.pop_front();
+            }
+            if (request->state == LoadState::Pending) {
+                if (request->target != nullptr) {
+                    request->target->upload(request->image);
+                    request->texture = request->target;
+                } else {
+                    request->texture = Texture::create(request->image);
+                }
+                request->image = {};
+                request->state = LoadState::Ready;
+            }
+            outstanding--;
+            finished.push_back(request);
+            double elapsed = std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+            if (elapsed >= budgetMs) {
+                break;
+            }
+        }
+        return finished;
+    }
+
+    bool AssetLoader::idle() const {
+        return outstanding == 0;
+    }
+
+}
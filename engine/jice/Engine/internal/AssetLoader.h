@@ -0,0 +1,132 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <queue>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+#include "Asset.h"
+#include "Texture.h"
+
+namespace jice {
+
+    enum class LoadPriority {
+        Low,
+        Normal,
+        High
+    };
+
+    enum class LoadState {
+        Pending, // queued, or decoded and waiting for its upload
+        Ready,
+        Failed,
+        Cancelled
+    };
+
+    // shared between a LoadHandle, the worker decoding it and the render thread uploading it
+    class LoadRequest {
+    public:
+        std::string name;
+        Asset asset;
+        std::atomic<LoadState> state{LoadState::Pending};
+        DecodedImage image;
+        std::string error;
+        Texture *texture = nullptr; // set once Ready
+        Texture *target = nullptr; // a reload uploads into this texture instead of creating a new one
+    };
+
+    class LoadHandle {
+    public:
+        LoadHandle() = default;
+
+        explicit LoadHandle(std::shared_ptr<LoadRequest> request) : request(std::move(request)) {}
+
+        [[nodiscard]] bool valid() const { return request != nullptr; }
+
+        [[nodiscard]] LoadState getState() const { return request->state; }
+
+        [[nodiscard]] bool done() const { return request->state != LoadState::Pending; }
+
+        // nullptr until the upload has happened
+        [[nodiscard]] Texture *getTexture() const {
+            return request->state == LoadState::Ready ? request->texture : nullptr;
+        }
+
+        [[nodiscard]] const std::string &getError() const { return request->error; }
+
+        // a cancelled load is skipped by the worker if it has not started, and never uploaded
+        void cancel() {
+            LoadState expected = LoadState::Pending;
+            request->state.compare_exchange_strong(expected, LoadState::Cancelled);
+        }
+
+    private:
+        std::shared_ptr<LoadRequest> request;
+    };
+
+    // Worker threads for asset work. Reading and decoding happen in the background, anything that
+    // needs GL is queued up for uploadReady, which the render thread calls once per frame.
+    class AssetLoader {
+    public:
+        // 0 = one less than the number of cores
+        explicit AssetLoader(unsigned int threads = 0);
+
+        ~AssetLoader();
+
+        LoadHandle loadTexture(const std::string &name, Asset asset, LoadPriority priority = LoadPriority::Normal,
+                               Texture *target = nullptr);
+
+        // arbitrary background work, higher priority jobs are picked first
+        void submit(std::function<void()> job, LoadPriority priority = LoadPriority::Normal);
+
+        // job runs on a worker, then done runs on the render thread from finishJobs
+        void submit(std::function<void()> job, std::function<void()> done, LoadPriority priority = LoadPriority::Normal);
+
+        // render thread only, runs the done callbacks of finished jobs
+        void finishJobs();
+
+        // render thread only. Uploads decoded textures until budgetMs is used up (always at least one),
+        // and hands back the requests that finished.
+        std::vector<std::shared_ptr<LoadRequest>> uploadReady(double budgetMs);
+
+        // true once every queued load has been decoded and uploaded
+        [[nodiscard]] bool idle() const;
+
+    private:
+        struct Job {
+            LoadPriority priority;
+            uint64_t seq;
+            std::function<void()> fn;
+        };
+
+        struct JobOrder {
+            bool operator()(const Job &a, const Job &b) const {
+                // priority_queue pops the "largest", so higher priority first, then oldest first
+                if (a.priority != b.priority) {
+                    return a.priority < b.priority;
+                }
+                return a.seq > b.seq;
+            }
+        };
+
+        std::priority_queue<Job, std::vector<Job>, JobOrder> jobs;
+        std::mutex jobMutex;
+        std::condition_variable jobCv;
+        uint64_t nextSeq = 0;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+
+        std::mutex readyMutex;
+        std::deque<std::shared_ptr<LoadRequest>> ready;
+        std::deque<std::function<void()>> finished;
+        std::atomic<size_t> outstanding{0};
+
+        void workerLoop();
+    };
+
+}
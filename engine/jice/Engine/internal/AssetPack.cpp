@@ -0,0 +1,96 @@
+#include "AssetPack.h"
+#include "Engine/util/FileMap.h"
+
+#include <iostream>
+#include <cstring>
+
+namespace jice {
+
+    uint64_t fnv1a64(const std::string &str) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c: str) {
+            hash ^= (uint8_t) c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    bool AssetPack::open(const std::string &path) {
+        size_t size = 0;
+        std::shared_ptr<const uint8_t> data = mapFile(path, size);
+        if (data == nullptr) {
+            std::cerr << "Failed to open asset pack: " << path << std::endl;
+            return false;
+        }
+        if (size < sizeof(JpakHeader)) {
+            std::cerr << "Asset pack is truncated: " << path << std::endl;
+            return false;
+        }
+        JpakHeader header{};
+        memcpy(&header, data.get(), sizeof(header));
+        if (header.magic != JPAK_MAGIC || header.version != JPAK_VERSION) {
+            std::cerr << "Not a version " << JPAK_VERSION << " asset pack: " << path << std::endl;
+            return false;
+        }
+        uint64_t tocEnd = sizeof(JpakHeader) + (uint64_t) header.count * sizeof(JpakEntry) + header.names_size;
+        if (tocEnd > size) {
+            std::cerr << "Asset pack is truncated: " << path << std::endl;
+            return false;
+        }
+        auto *toc = (const JpakEntry *) (data.get() + sizeof(JpakHeader));
+        for (uint32_t i = 0; i < header.count; i++) {
+            if (toc[i].offset + toc[i].size > size || toc[i].name_offset >= header.names_size) {
+                std::cerr << "Asset pack has a corrupt table of contents: " << path << std::endl;
+                return false;
+            }
+        }
+
+        file = std::move(data);
+        fileSize = size;
+        entries = toc;
+        count = header.count;
+        names = (const char *) (file.get() + sizeof(JpakHeader) + (size_t) count * sizeof(JpakEntry));
+        namesSize = header.names_size;
+        return true;
+    }
+
+    bool AssetPack::isOpen() const {
+        return file != nullptr;
+    }
+
+    bool AssetPack::find(const std::string &name, Asset &out) const {
+        uint64_t hash = fnv1a64(name);
+        // entries are sorted by hash, so binary search for the first candidate
+        uint32_t lo = 0, hi = count;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (entries[mid].name_hash < hash) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (uint32_t i = lo; i < count && entries[i].name_hash == hash; i++) {
+            if (name == names + entries[i].name_offset) {
+                out = getAsset(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t AssetPack::getCount() const {
+        return count;
+    }
+
+    std::string AssetPack::getName(uint32_t index) const {
+        return names + entries[index].name_offset;
+    }
+
+    Asset AssetPack::getAsset(uint32_t index) const {
+        const JpakEntry &entry = entries[index];
+        // aliasing constructor: a view into the mapping that keeps the whole mapping alive
+        return {std::shared_ptr<const uint8_t>(file, file.get() + entry.offset), (size_t) entry.size};
+    }
+
+}
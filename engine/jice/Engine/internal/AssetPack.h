@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <memory>
+
+#include "Asset.h"
+
+namespace jice {
+
+    // .jpak archive layout, written by jicc (keep in sync with write_pack in jicc/src/main.cpp)
+    // everything is little endian, and every blob starts on a JPAK_ALIGN boundary
+    //
+    //   JpakHeader
+    //   JpakEntry[count]      sorted by name_hash
+    //   names                 null terminated, names_size bytes
+    //   blobs
+    static const uint32_t JPAK_MAGIC = 0x4b41504a; // "JPAK"
+    static const uint32_t JPAK_VERSION = 1;
+    static const uint64_t JPAK_ALIGN = 16;
+
+    struct JpakHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+        uint32_t names_size;
+    };
+
+    struct JpakEntry {
+        uint64_t name_hash; // fnv1a64 of the asset name
+        uint64_t offset; // from the start of the file
+        uint64_t size;
+        uint32_t flags;
+        uint32_t name_offset; // into the names table
+    };
+
+    static_assert(sizeof(JpakHeader) == 16, "JpakHeader must be packed");
+    static_assert(sizeof(JpakEntry) == 32, "JpakEntry must be packed");
+
+    uint64_t fnv1a64(const std::string &str);
+
+    // A memory mapped .jpak. Assets handed out are views into the mapping (and keep it alive),
+    // only the pages that are actually touched are ever read from disk.
+    class AssetPack {
+    public:
+        bool open(const std::string &path);
+
+        [[nodiscard]] bool isOpen() const;
+
+        bool find(const std::string &name, Asset &out) const;
+
+        [[nodiscard]] uint32_t getCount() const;
+
+        [[nodiscard]] std::string getName(uint32_t index) const;
+
+        [[nodiscard]] Asset getAsset(uint32_t index) const;
+
+    private:
+        std::shared_ptr<const uint8_t> file;
+        size_t fileSize = 0;
+        const JpakEntry *entries = nullptr;
+        const char *names = nullptr;
+        uint32_t count = 0;
+        uint32_t namesSize = 0;
+    };
+
+}
@@ -1,8 +1,17 @@
 #include "Engine.h"
 #include "Engine/util/Popup.h"
+#include "Engine/builtin/Image2d.h"
+#include "Engine/util/Compression.h"
+#include "Engine/util/FileMap.h"
 #include "Asset.h"
 
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <filesystem>
 
 namespace jice {
 
@@ -37,6 +46,9 @@ namespace jice {
             std::cerr << "Failed to create window" << std::endl;
             return;
         }
+        // next to the game, wherever it is started from
+        std::string exeDir = executableDir();
+        shaderCache.open(exeDir.empty() ? "shader_cache" : exeDir + "/shader_cache");
     }
 
 
@@ -49,13 +61,23 @@ namespace jice {
         std::cout << assetLoc << std::endl;
         isSplash = true;
 
-        splashThread = std::thread(&Engine::keepSplashAlive, this, assetLoc);
+        // resolved here, the main thread keeps adding assets while the splash thread runs
+        splashThread = std::thread(&Engine::keepSplashAlive, this, getAsset(assetLoc));
     }
 
     void Engine::registerScript(const std::string &scr_name, ScriptDispatcher dispatcher) {
         scripts[scr_name] = dispatcher;
     }
 
+    void Engine::setScriptTable(const ScriptDescriptor *table, size_t count) {
+        scriptTable = table;
+        scriptCount = count;
+    }
+
+    void Engine::addPrefab(const std::string &pf_name, Prefab *prefab) {
+        prefabs[pf_name] = prefab;
+    }
+
     void Engine::addScene(const std::string &sc_name, Scene *scene) {
         scenes[sc_name] = scene;
     }
@@ -78,7 +100,10 @@ namespace jice {
     void Engine::update() {
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
+        processLoads();
         currentScene->Update();
+        // textures jicc premultiplied draw with their own blend function, switched only when it changes
+        bool premultipliedBlend = false;
         for (const auto &task: renderTasks) {
             if (task.simple) {
                 std::cout << "NOT SUPPORTED YET" << std::endl;
@@ -92,21 +117,36 @@ namespace jice {
                     std::cerr << "Texture not found" << std::endl;
                     continue;
                 }
-                EogllTexture *texture = getTexture(task.texture);
+                Texture *texture = getTexture(task.texture);
                 if (texture == nullptr) {
-                    std::cerr << "Failed to get texture" << std::endl;
-                    ErrorPopupWindow("Error", "Could not load texture: " + task.texture);
-                    continue;
+                    // still loading, it shows up in a later frame
+                    if (placeholderTexture == nullptr) {
+                        DecodedImage grey;
+                        grey.width = grey.height = 1;
+                        grey.storage = {128, 128, 128, 255};
+                        grey.pixels = AssetSpan(grey.storage.data(), grey.storage.size());
+                        placeholderTexture = Texture::create(grey);
+                    }
+                    texture = placeholderTexture;
+                }
+                if (texture->premultiplied != premultipliedBlend) {
+                    premultipliedBlend = texture->premultiplied;
+                    glBlendFunc(premultipliedBlend ? GL_ONE : GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
                 }
                 eogllUseProgram(shader);
-                eogllBindTexture(texture);
+                texture->bind();
                 eogllUpdateModelMatrix(&task.model, shader, "model");
                 eogllDrawBufferObject(task.obj, task.mode);
             }
 
         }
+        if (premultipliedBlend) {
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
 
         renderTasks.clear();
+        evictTextures();
+        frame++;
         eogllSwapBuffers(ewindow);
         eogllPollEvents(ewindow);
         if (eogllWindowShouldClose(ewindow)) {
@@ -117,8 +157,7 @@ namespace jice {
     void Engine::setup() {
         glfwShowWindow(ewindow->window);
         glfwFocusWindow(ewindow->window);
-        // get first scene
-        currentScene = scenes.begin()->second;
+        currentScene = firstScene();
         currentScene->Setup();
         isRunning = true;
     }
@@ -128,6 +167,9 @@ namespace jice {
         while (isRunning) {
             update();
         }
+        if (shaderCache.isEnabled()) {
+            std::cout << "Shader cache: " << shaderCache.hits << " hits, " << shaderCache.misses << " misses" << std::endl;
+        }
         eogllDestroyWindow(ewindow);
         eogllTerminate();
     }
@@ -137,7 +179,41 @@ namespace jice {
     }
 
     ScriptInterface *Engine::dispatchScript(const std::string &scr_name, GameObject *obj) {
-        return scripts[scr_name](this, obj);
+        auto it = scripts.find(scr_name);
+        if (it != scripts.end()) {
+            return it->second(this, obj);
+        }
+        const ScriptDescriptor *end = scriptTable + scriptCount;
+        const ScriptDescriptor *desc = std::lower_bound(scriptTable, end, scr_name,
+                                                        [](const ScriptDescriptor &d, const std::string &n) {
+                                                            return d.name < n;
+                                                        });
+        if (desc != end && desc->name == scr_name) {
+            return desc->create(this, obj);
+        }
+        std::cerr << "Script not found: " << scr_name << std::endl;
+        ErrorPopupWindow("Error", "Script '" + scr_name + "' not found");
+        return nullptr;
+    }
+
+    ScriptInterface *Engine::dispatchScript(uint32_t id, GameObject *obj) {
+        if (id >= scriptCount) {
+            std::cerr << "Script id out of range: " << id << std::endl;
+            ErrorPopupWindow("Error", "Script id " + std::to_string(id) + " out of range");
+            return nullptr;
+        }
+        return scriptTable[id].create(this, obj);
+    }
+
+    GameObject *Engine::instantiate(const std::string &pf_name, const std::string &obj_name,
+                                    const PrefabOverrides &overrides) {
+        auto it = prefabs.find(pf_name);
+        if (it == prefabs.end()) {
+            std::cerr << "Prefab not found: " << pf_name << std::endl;
+            ErrorPopupWindow("Error", "Prefab '" + pf_name + "' not found");
+            return nullptr;
+        }
+        return it->second->instantiate(this, obj_name, overrides);
     }
 
     void Engine::addRenderTask(const RenderTask &task) {
@@ -148,7 +224,24 @@ namespace jice {
         assets[asset_name] = std::move(asset);
     }
 
-    void Engine::keepSplashAlive(const std::string &assetLoc) {
+    bool Engine::addAssetPack(const std::string &path) {
+        AssetPack pack;
+        if (!pack.open(path)) {
+            return false;
+        }
+        assetPacks.push_back(std::move(pack));
+        return true;
+    }
+
+    void Engine::addAssetTable(const AssetDescriptor *table, size_t count) {
+        assetTables.emplace_back(table, count);
+    }
+
+    void Engine::addShaderTable(const ShaderProgramDescriptor *table, size_t count) {
+        shaderTables.emplace_back(table, count);
+    }
+
+    void Engine::keepSplashAlive(Asset splashAsset) {
         EogllWindowHints hints = eogllDefaultWindowHints();
         hints.resizable = false;
         hints.decorated = false;
@@ -210,8 +303,14 @@ void main() {
         eogllBuildAttributes(&builder, vao);
         EogllBufferObject splashBuffer = eogllCreateBufferObject(vao, vbo, ebo, sizeof(indices), GL_UNSIGNED_INT);
 
-        Asset a = getAsset(assetLoc);
-        EogllTexture *splashTexture = eogllCreateTextureFromBuffer(a.getData().data(), a.getData().size());
+        // same path as every other texture, so an imported .jtex splash works too
+        DecodedImage splashImage;
+        std::string error;
+        if (!decodeImage(splashAsset, splashImage, error)) {
+            std::cerr << "Failed to decode splash image: " << error << std::endl;
+        }
+        Texture *splashTexture = Texture::create(splashImage);
+        splashImage = {};
 
         glfwFocusWindow(splashWindow->window);
 
@@ -220,7 +319,7 @@ void main() {
             glClear(GL_COLOR_BUFFER_BIT);
 
             eogllUseProgram(splashProgram);
-            eogllBindTexture(splashTexture);
+            splashTexture->bind();
             eogllDrawBufferObject(&splashBuffer, GL_TRIANGLES);
 
             eogllSwapBuffers(splashWindow);
@@ -228,73 +327,412 @@ void main() {
         }
         eogllDestroyWindow(splashWindow);
         eogllDeleteProgram(splashProgram);
-        eogllDeleteTexture(splashTexture);
+        splashTexture->destroy();
+        delete splashTexture;
         eogllDeleteBufferObject(&splashBuffer);
     }
 
-    EogllTexture *Engine::getTexture(const std::string &tex_name) {
-        // if texture exists in map
-        if (textures.find(tex_name) != textures.end()) {
-            return textures[tex_name];
+    Texture *Engine::getTexture(const std::string &tex_name, bool wait) {
+        if (findAsset(tex_name, false) != nullptr) {
+            auto it = textures.find(textureOwner(tex_name));
+            if (it != textures.end()) {
+                it->second.lastUsed = frame;
+                textureStats.hits++;
+                return it->second.texture;
+            }
+        }
+        textureStats.misses++;
+        LoadHandle handle = requestTexture(tex_name, LoadPriority::High);
+        while (wait && !handle.done()) {
+            processLoads();
+            std::this_thread::yield();
+        }
+        if (handle.getState() == LoadState::Failed) {
+            std::cerr << "Failed to get texture" << std::endl;
+            ErrorPopupWindow("Error", "Could not load texture: " + tex_name);
+        }
+        return handle.getTexture();
+    }
+
+    LoadHandle Engine::requestTexture(const std::string &tex_name, LoadPriority priority) {
+        // compressed textures are inflated on the loader's workers, not here
+        const Asset *found = findAsset(tex_name, false);
+        const Asset &asset = found != nullptr ? *found : getAsset(tex_name);
+        std::string key = textureOwner(tex_name);
+        auto it = textureLoads.find(key);
+        if (it != textureLoads.end() && it->second.getState() != LoadState::Cancelled) {
+            return it->second;
+        }
+        std::cout << "Loading texture '" << tex_name << "'" << std::endl;
+        // loaded under its owner's name, which is what processLoads caches it by
+        LoadHandle handle = loader.loadTexture(key, asset, priority);
+        textureLoads[key] = handle;
+        return handle;
+    }
+
+    void Engine::processLoads() {
+        reloadChangedAssets();
+        loader.finishJobs();
+        for (const auto &request: loader.uploadReady(uploadBudgetMs)) {
+            if (request->state == LoadState::Ready) {
+                textures[request->name] = {request->texture, frame};
+            } else if (request->state == LoadState::Failed) {
+                std::cerr << "Failed to decode texture '" << request->name << "': " << request->error << std::endl;
+            }
+        }
+    }
+
+    void Engine::requestObjectTextures(const std::vector<GameObject *> &objects) {
+        for (auto object: objects) {
+            auto *image = object->getComponent(Image2d);
+            if (image != nullptr && !image->image.empty()) {
+                requestTexture(image->image);
+            }
+            requestObjectTextures(object->children);
+        }
+    }
+
+    void Engine::preload() {
+        auto start = std::chrono::high_resolution_clock::now();
+        // issued first, so the driver compiles while the textures decode
+        std::vector<PendingProgram> pending = beginShaders();
+        size_t programs = pending.size();
+        Scene *scene = firstScene();
+        if (scene != nullptr) {
+            requestObjectTextures(scene->children);
+        }
+        while (!loader.idle() || !pending.empty()) {
+            processLoads();
+            finishShaders(pending);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::cout << "Preloaded " << (scene != nullptr ? "scene '" + scene->name + "' and " : "") << programs
+                  << " shader programs" << (shaderCache.isParallel() ? " (parallel compile)" : "") << " in "
+                  << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count()
+                  << "ms" << std::endl;
+    }
+
+    std::vector<PendingProgram> Engine::beginShaders() {
+        std::vector<PendingProgram> pending;
+        for (const auto &[table, count]: shaderTables) {
+            for (size_t i = 0; i < count; i++) {
+                const ShaderProgramDescriptor &desc = table[i];
+                if (shaders.find(desc.name) != shaders.end()) {
+                    continue;
+                }
+                const Asset *vertAsset = findAsset(desc.vert);
+                const Asset *fragAsset = findAsset(desc.frag);
+                if (vertAsset == nullptr || fragAsset == nullptr) {
+                    continue; // getShader reports it if the program is ever used
+                }
+                AssetSpan vert = vertAsset->getData();
+                AssetSpan frag = fragAsset->getData();
+                pending.push_back(shaderCache.begin(desc.name, std::string(vert.begin(), vert.end()),
+                                                    std::string(frag.begin(), frag.end())));
+            }
+        }
+        return pending;
+    }
+
+    void Engine::finishShaders(std::vector<PendingProgram> &pending) {
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (!shaderCache.isDone(*it)) {
+                ++it;
+                continue;
+            }
+            EogllShaderProgram *shader = shaderCache.finish(*it);
+            if (shader != nullptr) {
+                shaders[it->name] = shader;
+            }
+            it = pending.erase(it);
+        }
+    }
+
+    void Engine::evictTextures() {
+        if (textureBudget == 0) {
+            return;
+        }
+        size_t resident = 0;
+        std::vector<std::pair<uint64_t, std::string>> candidates;
+        for (const auto &[key, entry]: textures) {
+            resident += entry.texture->bytes;
+            auto load = textureLoads.find(key);
+            // a pending reload still uploads into this texture
+            bool reloading = load != textureLoads.end() && !load->second.done();
+            if (entry.lastUsed < frame && !reloading) {
+                candidates.emplace_back(entry.lastUsed, key);
+            }
+        }
+        if (resident <= textureBudget) {
+            return;
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto &[lastUsed, key]: candidates) {
+            if (resident <= textureBudget) {
+                break;
+            }
+            Texture *texture = textures[key].texture;
+            resident -= texture->bytes;
+            texture->destroy();
+            delete texture;
+            textures.erase(key);
+            textureLoads.erase(key);
+            textureStats.evictions++;
+        }
+    }
+
+    TextureStats Engine::getTextureStats() const {
+        TextureStats stats = textureStats;
+        for (const auto &[key, entry]: textures) {
+            stats.residentCount++;
+            stats.residentBytes += entry.texture->bytes;
         }
-        Asset a = getAsset(tex_name);
-        std::cout << "Creating texture '" << tex_name << "'" << std::endl;
-        EogllTexture *texture = eogllCreateTextureFromBuffer(a.getData().data(), a.getData().size());
-        textures[tex_name] = texture;
-        return texture;
+        return stats;
+    }
 
+    Scene *Engine::firstScene() {
+        if (scenes.empty()) {
+            return nullptr;
+        }
+        return scenes.begin()->second;
     }
 
     EogllShaderProgram *Engine::getShader(const std::string &shader_name) {
-        if (shaders.find(shader_name) != shaders.end()) {
-            return shaders[shader_name];
+        auto it = shaders.find(shader_name);
+        if (it != shaders.end()) {
+            return it->second;
+        }
+        EogllShaderProgram *shader = linkShader(shader_name);
+        if (shader != nullptr) {
+            shaders[shader_name] = shader;
+        }
+        return shader;
+    }
+
+    EogllShaderProgram *Engine::linkShader(const std::string &shader_name) {
+        for (const auto &[table, count]: shaderTables) {
+            const ShaderProgramDescriptor *end = table + count;
+            const ShaderProgramDescriptor *desc = std::lower_bound(table, end, shader_name,
+                    [](const ShaderProgramDescriptor &d, const std::string &name) { return strcmp(d.name, name.c_str()) < 0; });
+            if (desc == end || shader_name != desc->name) {
+                continue;
+            }
+            const Asset *vertAsset = findAsset(desc->vert);
+            const Asset *fragAsset = findAsset(desc->frag);
+            if (vertAsset == nullptr || fragAsset == nullptr) {
+                getAsset(vertAsset == nullptr ? desc->vert : desc->frag);
+                return nullptr;
+            }
+            AssetSpan vert = vertAsset->getData();
+            AssetSpan frag = fragAsset->getData();
+            return shaderCache.link(std::string(vert.begin(), vert.end()), std::string(frag.begin(), frag.end()));
         }
+        // not generated by jicc, fall back to finding the stages by name
         // shader program test_3f2f_pt is a program that would be created by having the files:
         // test_3f2f_pt.(vert/vs) and test_3f2f_pt.(frag/fs)
         // in the assets folder
         // this asset can be any type of asset
-        Asset vertAsset;
-        if (assets.find(shader_name + ".vert") != assets.end()) {
-            vertAsset = assets[shader_name + ".vert"];
-        } else if (assets.find(shader_name + ".vs") != assets.end()) {
-            vertAsset = assets[shader_name + ".vs"];
-        } else {
+        const Asset *vertAsset = findAsset(shader_name + ".vert");
+        if (vertAsset == nullptr) {
+            vertAsset = findAsset(shader_name + ".vs");
+        }
+        if (vertAsset == nullptr) {
             getAsset(shader_name + ".vert");
             return nullptr;
         }
-        Asset fragAsset;
-        if (assets.find(shader_name + ".frag") != assets.end()) {
-            fragAsset = assets[shader_name + ".frag"];
-        } else if (assets.find(shader_name + ".fs") != assets.end()) {
-            fragAsset = assets[shader_name + ".fs"];
-        } else {
+        const Asset *fragAsset = findAsset(shader_name + ".frag");
+        if (fragAsset == nullptr) {
+            fragAsset = findAsset(shader_name + ".fs");
+        }
+        if (fragAsset == nullptr) {
             getAsset(shader_name + ".frag");
             return nullptr;
         }
-        // convert asset's uint8_t vector to char*
-        char *vertData = new char[vertAsset.getData().size()];
-        for (int i = 0; i < vertAsset.getData().size(); i++) {
-            vertData[i] = static_cast<char>(vertAsset.getData()[i]);
+        // GL wants null terminated sources, and the asset data is not
+        AssetSpan vert = vertAsset->getData();
+        AssetSpan frag = fragAsset->getData();
+        std::string vertData(vert.begin(), vert.end());
+        std::string fragData(frag.begin(), frag.end());
+        return shaderCache.link(vertData, fragData);
+    }
+
+    bool Engine::watchAssets(const std::string &dir) {
+        if (!assetWatcher.watch(dir)) {
+            return false;
+        }
+        assetWatchDir = dir;
+        std::cout << "Watching '" << dir << "' for changes" << std::endl;
+        return true;
+    }
+
+    void Engine::reloadChangedAssets() {
+        for (const auto &path: assetWatcher.poll()) {
+            // read into memory rather than mapped, the next save may truncate the file under a mapping
+            auto fresh = std::make_shared<Asset>();
+            std::string file = assetWatchDir + "/" + path;
+            loader.submit([file, fresh] {
+                std::ifstream in(file, std::ios::binary);
+                if (in.is_open()) {
+                    *fresh = Asset(std::vector<uint8_t>(std::istreambuf_iterator<char>(in),
+                                                        std::istreambuf_iterator<char>()));
+                }
+            }, [this, path, fresh] {
+                swapAsset(path, *fresh);
+            }, LoadPriority::High);
+        }
+    }
+
+    void Engine::swapAsset(const std::string &asset_name, const Asset &fresh) {
+        auto it = assets.find(asset_name);
+        if (it == assets.end()) {
+            return; // not something the game has loaded
         }
-        vertData[vertAsset.getData().size()] = '\0';
-        char *fragData = new char[fragAsset.getData().size()];
-        for (int i = 0; i < fragAsset.getData().size(); i++) {
-            fragData[i] = static_cast<char>(fragAsset.getData()[i]);
+        if (fresh.empty()) {
+            std::cerr << "Failed to reload asset '" << asset_name << "'" << std::endl;
+            return;
         }
-        fragData[fragAsset.getData().size()] = '\0';
-        EogllShaderProgram *shader = eogllLinkProgram(vertData, fragData);
-        shaders[shader_name] = shader;
-        // print shader source
-        return shader;
+        std::string key = textureOwner(asset_name);
+        // Names jicc deduplicated keep the old bytes, only the file that changed is swapped. If others
+        // share its texture they keep it, and asset_name goes on under a texture of its own.
+        std::vector<std::string> sharing;
+        for (const auto &[name, owner]: assetOwners) {
+            if (owner == key && name != asset_name) {
+                sharing.push_back(name);
+            }
+        }
+        it->second = fresh;
+        std::cout << "Reloaded asset '" << asset_name << "'" << std::endl;
+        if (!sharing.empty() || key != asset_name) {
+            if (key == asset_name) {
+                // the others need a new owner, the texture moves to it
+                std::string heir = *std::min_element(sharing.begin(), sharing.end());
+                for (const auto &name: sharing) {
+                    assetOwners[name] = heir;
+                }
+                for (auto &[blob, owner]: packOwners) {
+                    if (owner == key) {
+                        owner = heir;
+                    }
+                }
+                auto texture = textures.find(key);
+                if (texture != textures.end()) {
+                    textures[heir] = texture->second;
+                    textures.erase(key);
+                }
+                auto load = textureLoads.find(key);
+                if (load != textureLoads.end()) {
+                    // a pending load would land under the old key, the heir requests its own
+                    load->second.cancel();
+                    if (load->second.getState() == LoadState::Ready) {
+                        textureLoads[heir] = load->second;
+                    }
+                    textureLoads.erase(key);
+                }
+            }
+            // loaded fresh the next time it is drawn
+            assetOwners[asset_name] = asset_name;
+            key = asset_name;
+        }
+
+        auto texture = textures.find(key);
+        if (texture != textures.end()) {
+            // the old image keeps being drawn until the new one is uploaded into the same texture
+            textureLoads[key] = loader.loadTexture(key, fresh, LoadPriority::High, texture->second.texture);
+        } else {
+            auto load = textureLoads.find(key);
+            if (load != textureLoads.end()) {
+                // never uploaded, the next getTexture starts over with the new data
+                load->second.cancel();
+                textureLoads.erase(load);
+            }
+        }
+
+        std::string ext = std::filesystem::path(asset_name).extension().string();
+        if (ext == ".vert" || ext == ".vs" || ext == ".frag" || ext == ".fs") {
+            std::string shader_name = asset_name.substr(0, asset_name.size() - ext.size());
+            auto shader = shaders.find(shader_name);
+            if (shader != shaders.end()) {
+                EogllShaderProgram *program = linkShader(shader_name);
+                if (program == nullptr) {
+                    std::cerr << "Failed to relink shader '" << shader_name << "', keeping the old one" << std::endl;
+                    return;
+                }
+                ShaderCache::release(shader->second);
+                shader->second = program;
+                std::cout << "Relinked shader '" << shader_name << "'" << std::endl;
+            }
+        }
+    }
+
+    const Asset *Engine::findAsset(const std::string &asset_name, bool decompress) {
+        Asset *found = nullptr;
+        auto it = assets.find(asset_name);
+        if (it != assets.end()) {
+            found = &it->second;
+        }
+        for (const auto &[table, count]: assetTables) {
+            if (found != nullptr) {
+                break;
+            }
+            // first use, materialize it from its descriptor
+            const AssetDescriptor *end = table + count;
+            const AssetDescriptor *desc = std::lower_bound(table, end, asset_name,
+                    [](const AssetDescriptor &d, const std::string &name) { return strcmp(d.name, name.c_str()) < 0; });
+            if (desc == end || asset_name != desc->name) {
+                continue;
+            }
+            Asset asset;
+            if (desc->shares != nullptr) {
+                // one handle for both names, so they also share a texture
+                if (const Asset *owner = findAsset(desc->shares, false)) {
+                    asset = *owner;
+                }
+                assetOwners[asset_name] = textureOwner(desc->shares);
+            } else if (desc->data != nullptr) {
+                asset = CompiledAsset(desc->data, *desc->length);
+            } else {
+                asset = CopiedAsset(desc->path);
+            }
+            found = &(assets[asset_name] = std::move(asset));
+        }
+        if (found == nullptr) {
+            for (const auto &pack: assetPacks) {
+                Asset asset;
+                if (pack.find(asset_name, asset)) {
+                    found = &(assets[asset_name] = std::move(asset));
+                    // duplicates in a pack point at the same blob, which lives as long as the pack
+                    assetOwners[asset_name] = packOwners.emplace(found->getData().data(), asset_name).first->second;
+                    break;
+                }
+            }
+        }
+        if (found != nullptr && decompress && isCompressed(found->getData())) {
+            // the inflated copy replaces the entry, so this only happens once per asset
+            Asset inflated;
+            std::string error;
+            if (!decompressAsset(*found, inflated, error)) {
+                std::cerr << "Failed to decompress asset '" << asset_name << "': " << error << std::endl;
+                return nullptr;
+            }
+            *found = std::move(inflated);
+        }
+        return found;
+    }
+
+    std::string Engine::textureOwner(const std::string &asset_name) {
+        findAsset(asset_name, false);
+        auto it = assetOwners.find(asset_name);
+        return it != assetOwners.end() ? it->second : asset_name;
     }
 
-    Asset Engine::getAsset(const std::string &asset_name) {
-        if (assets.find(asset_name) != assets.end()) {
-            return assets[asset_name];
+    const Asset &Engine::getAsset(const std::string &asset_name) {
+        if (const Asset *asset = findAsset(asset_name)) {
+            return *asset;
         }
         std::cerr << "Asset not found: " << asset_name << std::endl;
         ErrorPopupWindow("Error", "Asset '" + asset_name + "' not found");
-        return {};
+        static const Asset missing;
+        return missing;
     }
 
 }
\ No newline at end of file
@@ -4,7 +4,13 @@
 #include "Object.h"
 #include "Scripting.h"
 #include "Asset.h"
+#include "AssetPack.h"
+#include "AssetLoader.h"
+#include "Texture.h"
+#include "ShaderCache.h"
+#include "Prefab.h"
 #include "RenderTask.h"
+#include "Engine/util/FileWatcher.h"
 #include <eogll.h>
 
 #include <functional>
@@ -14,6 +20,14 @@ namespace jice {
 
     typedef std::function<ScriptInterface *(Engine *e, GameObject *o)> ScriptDispatcher;
 
+    typedef ScriptInterface *(*ScriptFactory)(Engine *e, GameObject *o);
+
+    // one script jicc compiled, its index in the table is the id scenes and prefabs dispatch it by
+    struct ScriptDescriptor {
+        const char *name;
+        ScriptFactory create;
+    };
+
     class Engine {
     public:
         EogllWindow* ewindow;
@@ -24,10 +38,29 @@ namespace jice {
 
         std::unordered_map<std::string, Scene *> scenes;
         std::unordered_map<std::string, ScriptDispatcher> scripts;
+        const ScriptDescriptor *scriptTable = nullptr;
+        size_t scriptCount = 0;
+        std::unordered_map<std::string, Prefab *> prefabs;
         std::unordered_map<std::string, Asset> assets;
+        std::vector<AssetPack> assetPacks;
+        std::vector<std::pair<const AssetDescriptor *, size_t>> assetTables;
         std::vector<RenderTask> renderTasks;
-        std::unordered_map<std::string, EogllTexture *> textures;
+        // Keyed by the asset that owns the texture's bytes. jicc stores identical files once, so every asset
+        // name with the same content resolves to the same owner and shares one texture.
+        std::unordered_map<std::string, TextureEntry> textures;
+        std::unordered_map<std::string, LoadHandle> textureLoads;
+        // estimated GPU memory textures may use before the least recently drawn ones are evicted, 0 = no limit.
+        // Evicted textures are loaded again from their asset the next time they are drawn.
+        size_t textureBudget = 0;
+        // drawn in place of textures that are still loading
+        Texture *placeholderTexture = nullptr;
+        uint64_t frame = 0;
+        AssetLoader loader;
+        // time per frame the render thread may spend uploading finished loads
+        double uploadBudgetMs = 2.0;
         std::unordered_map<std::string, EogllShaderProgram *> shaders;
+        std::vector<std::pair<const ShaderProgramDescriptor *, size_t>> shaderTables;
+        ShaderCache shaderCache;
         std::string id;
         std::string name;
         std::string description;
@@ -52,8 +85,22 @@ namespace jice {
 
         void registerScript(const std::string &scr_name, ScriptDispatcher dispatcher);
 
+        // the scripts jicc compiled, table must be sorted by name and outlive the engine
+        void setScriptTable(const ScriptDescriptor *table, size_t count);
+
         void addAsset(const std::string &name, Asset asset);
 
+        // mounts a .jpak, its assets are looked up on first use
+        bool addAssetPack(const std::string &path);
+
+        // table must be sorted by name and outlive the engine, its assets are materialized on first use
+        void addAssetTable(const AssetDescriptor *table, size_t count);
+
+        // programs jicc generated, table must be sorted by name and outlive the engine
+        void addShaderTable(const ShaderProgramDescriptor *table, size_t count);
+
+        void addPrefab(const std::string &pf_name, Prefab *prefab);
+
         void addScene(const std::string &sc_name, Scene *scene);
 
         void loadConfig(const std::string &path);
@@ -70,18 +117,76 @@ namespace jice {
 
         void addRenderTask(const RenderTask &task);
 
+        // a script that doesn't exist is fatal: both overloads show an error popup and exit, so callers
+        // never get nullptr
         ScriptInterface *dispatchScript(const std::string &name, GameObject *obj);
 
-        EogllTexture *getTexture(const std::string &tex_name);
+        // by index into scriptTable
+        ScriptInterface *dispatchScript(uint32_t id, GameObject *obj);
+
+        GameObject *instantiate(const std::string &pf_name, const std::string &obj_name,
+                                const PrefabOverrides &overrides = {});
+
+        // nullptr while the texture is still loading, unless wait is set
+        Texture *getTexture(const std::string &tex_name, bool wait = false);
+
+        LoadHandle requestTexture(const std::string &tex_name, LoadPriority priority = LoadPriority::Normal);
+
+        // uploads whatever the loader finished, within uploadBudgetMs
+        void processLoads();
+
+        // loads everything the first scene shows and compiles every program jicc generated,
+        // meant to run while the splash is up
+        void preload();
+
+        // Reloads copy-mode assets under dir when their files change, textures are re-uploaded and shaders
+        // relinked in place at the start of a frame. Linux only, returns false elsewhere.
+        bool watchAssets(const std::string &dir = "assets");
+
+        Scene *firstScene();
+
+        [[nodiscard]] TextureStats getTextureStats() const;
 
         EogllShaderProgram *getShader(const std::string &shader_name);
 
-        Asset getAsset(const std::string &asset_name);
+        const Asset &getAsset(const std::string &asset_name);
 
         ~Engine();
 
     private:
-        void keepSplashAlive(const std::string &assetLoc);
+        void keepSplashAlive(Asset splashAsset);
+
+        // decompress = false hands back .jcmp data as stored, for callers that inflate it elsewhere
+        const Asset *findAsset(const std::string &asset_name, bool decompress = true);
+
+        void requestObjectTextures(const std::vector<GameObject *> &objects);
+
+        // asset name -> the name its bytes were first materialized under, set when an asset is first found
+        std::unordered_map<std::string, std::string> assetOwners;
+        std::unordered_map<const uint8_t *, std::string> packOwners; // blob in a mounted pack -> its owner
+
+        // the key asset_name's texture is cached under
+        std::string textureOwner(const std::string &asset_name);
+
+        TextureStats textureStats;
+
+        // frees least recently used textures until they fit in textureBudget, never ones drawn this frame
+        void evictTextures();
+
+        FileWatcher assetWatcher;
+        std::string assetWatchDir;
+
+        void reloadChangedAssets();
+
+        void swapAsset(const std::string &asset_name, const Asset &fresh);
+
+        EogllShaderProgram *linkShader(const std::string &shader_name);
+
+        // issues every program in shaderTables that isn't linked yet
+        std::vector<PendingProgram> beginShaders();
+
+        // moves the programs that are done into shaders, without waiting on the rest
+        void finishShaders(std::vector<PendingProgram> &pending);
     };
 
 }
\ No newline at end of file
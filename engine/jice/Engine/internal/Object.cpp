@@ -84,14 +84,62 @@ namespace jice {
         }
     }
 
-    Attribute::Attribute(Engine *e, const std::string &id, const AttributeData &data) {
+    LayeredAttributeData::LayeredAttributeData() = default;
+
+    LayeredAttributeData::LayeredAttributeData(AttributeData data) {
+        overrides = std::move(data);
+    }
+
+    LayeredAttributeData::LayeredAttributeData(SharedAttributeData defaults, AttributeData overrides) {
+        this->defaults = std::move(defaults);
+        this->overrides = std::move(overrides);
+    }
+
+    const AttrData *LayeredAttributeData::find(const std::string &key) const {
+        auto it = overrides.find(key);
+        if (it != overrides.end()) {
+            return &it->second;
+        }
+        if (defaults != nullptr) {
+            auto dit = defaults->find(key);
+            if (dit != defaults->end()) {
+                return &dit->second;
+            }
+        }
+        return nullptr;
+    }
+
+    bool LayeredAttributeData::contains(const std::string &key) const {
+        return find(key) != nullptr;
+    }
+
+    void LayeredAttributeData::set(const std::string &key, const AttrData &value) {
+        overrides[key] = value;
+    }
+
+    bool LayeredAttributeData::empty() const {
+        return overrides.empty() && (defaults == nullptr || defaults->empty());
+    }
+
+    AttributeData LayeredAttributeData::flatten() const {
+        AttributeData out;
+        if (defaults != nullptr) {
+            out = *defaults;
+        }
+        for (const auto &[key, value]: overrides) {
+            out[key] = value;
+        }
+        return out;
+    }
+
+    Attribute::Attribute(Engine *e, const std::string &id, const LayeredAttributeData &data) {
         isScript = false;
         this->id = id;
         script = nullptr;
         builtin = createBuiltinAttr(e, id, data);
     }
 
-    Attribute::Attribute(ScriptInterface *scr, AttributeData data, const std::string &scr_name) {
+    Attribute::Attribute(ScriptInterface *scr, LayeredAttributeData data, const std::string &scr_name) {
         isScript = true;
         script = scr;
         scriptName = scr_name;
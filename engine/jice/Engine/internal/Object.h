@@ -2,8 +2,10 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <memory>
 
 #include "Scripting.h"
+#include "State.h"
 
 namespace jice {
 
@@ -49,21 +51,54 @@ namespace jice {
 
 
     typedef std::unordered_map<std::string, AttrData> AttributeData;
+    typedef std::shared_ptr<const AttributeData> SharedAttributeData;
+
+    // Attribute data split into immutable defaults (shared between every instance of a prefab)
+    // and the fields this instance overrides. Writes only ever touch the overrides (copy-on-write),
+    // so an instance costs as much as the fields it changes, not the whole attribute.
+    class LayeredAttributeData {
+    public:
+        SharedAttributeData defaults;
+        AttributeData overrides;
+
+        LayeredAttributeData();
+
+        // not explicit, so plain AttributeData can be passed anywhere layered data is expected
+        LayeredAttributeData(AttributeData data);
+
+        LayeredAttributeData(SharedAttributeData defaults, AttributeData overrides);
+
+        [[nodiscard]] const AttrData *find(const std::string &key) const;
+
+        [[nodiscard]] bool contains(const std::string &key) const;
+
+        void set(const std::string &key, const AttrData &value);
+
+        [[nodiscard]] bool empty() const;
+
+        // merged copy of defaults + overrides
+        [[nodiscard]] AttributeData flatten() const;
+    };
 
     class GameObject;
 
     class AttributeInterface {
     public:
-        AttributeData data;
+        LayeredAttributeData data;
 
-        AttributeInterface(AttributeData data) : data(data) {}
+        AttributeInterface(LayeredAttributeData data) : data(std::move(data)) {}
 
         virtual void Update(Engine *e, GameObject *obj) = 0;
 
         virtual std::vector<std::string> getDependencies() = 0;
+
+        // runtime state for scene snapshots, components with no mutable state can leave these empty
+        virtual void saveState(StateWriter &out) {}
+
+        virtual void loadState(StateReader &in) {}
     };
 
-    AttributeInterface *createBuiltinAttr(Engine *e, const std::string &id, const AttributeData &data);
+    AttributeInterface *createBuiltinAttr(Engine *e, const std::string &id, const LayeredAttributeData &data);
 
     class Attribute {
     public:
@@ -71,15 +106,15 @@ namespace jice {
         // script stuff
         ScriptInterface *script{};
         std::string scriptName;
-        AttributeData data;
+        LayeredAttributeData data;
 
         // builtin stuff
         AttributeInterface *builtin;
         std::string id;
 
-        Attribute(Engine *e, const std::string &id, const AttributeData &data);
+        Attribute(Engine *e, const std::string &id, const LayeredAttributeData &data);
 
-        Attribute(ScriptInterface *scr, AttributeData data, const std::string &scr_name);
+        Attribute(ScriptInterface *scr, LayeredAttributeData data, const std::string &scr_name);
 
     };
 
@@ -0,0 +1,43 @@
+#include "Prefab.h"
+#include "Engine.h"
+
+namespace jice {
+
+    Prefab::Prefab(std::string name) {
+        this->name = std::move(name);
+    }
+
+    void Prefab::addBuiltin(const std::string &id, AttributeData defaults) {
+        attributes.push_back({false, id, std::make_shared<const AttributeData>(std::move(defaults))});
+    }
+
+    void Prefab::addScript(const std::string &location, AttributeData defaults) {
+        attributes.push_back({true, location, std::make_shared<const AttributeData>(std::move(defaults))});
+    }
+
+    void Prefab::addScript(const std::string &location, uint32_t script, AttributeData defaults) {
+        attributes.push_back({true, location, std::make_shared<const AttributeData>(std::move(defaults)),
+                              (int32_t) script});
+    }
+
+    GameObject *Prefab::instantiate(Engine *e, const std::string &obj_name, const PrefabOverrides &overrides) const {
+        auto *obj = new GameObject(obj_name);
+        for (const auto &entry: attributes) {
+            AttributeData over;
+            auto it = overrides.find(entry.id);
+            if (it != overrides.end()) {
+                over = it->second;
+            }
+            LayeredAttributeData data(entry.defaults, std::move(over));
+            if (entry.isScript) {
+                ScriptInterface *script = entry.script >= 0 ? e->dispatchScript((uint32_t) entry.script, obj)
+                                                            : e->dispatchScript(entry.id, obj);
+                obj->addAttribute(new Attribute(script, std::move(data), entry.id));
+            } else {
+                obj->addAttribute(new Attribute(e, entry.id, data));
+            }
+        }
+        return obj;
+    }
+
+}
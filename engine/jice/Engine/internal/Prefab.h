@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Object.h"
+
+namespace jice {
+
+    // overrides for one prefab instance, keyed by attribute id (builtin id or script location)
+    typedef std::unordered_map<std::string, AttributeData> PrefabOverrides;
+
+    class Prefab {
+    public:
+        struct Entry {
+            bool isScript;
+            std::string id; // builtin id, or script location
+            SharedAttributeData defaults;
+            int32_t script = -1; // id in the engine's script table, -1 = dispatched by name
+        };
+
+        std::string name;
+        std::vector<Entry> attributes;
+
+        explicit Prefab(std::string name);
+
+        virtual ~Prefab() = default;
+
+        void addBuiltin(const std::string &id, AttributeData defaults);
+
+        void addScript(const std::string &location, AttributeData defaults);
+
+        // script is the id jicc gave it
+        void addScript(const std::string &location, uint32_t script, AttributeData defaults);
+
+        // every instance points at the same defaults, only the overrides are copied
+        GameObject *instantiate(Engine *e, const std::string &obj_name, const PrefabOverrides &overrides) const;
+    };
+
+}
@@ -1,4 +1,5 @@
 #include "Scene.h"
+#include "Engine.h"
 
 #include <iostream>
 
@@ -39,6 +40,7 @@ namespace jice {
                 }
             }
         }
+        captureBaseline();
     }
 
     void Scene::Update() {
@@ -60,4 +62,253 @@ namespace jice {
             }
         }
     }
+
+    static AttributeData tableData(const SceneTable &table, const SceneAttributeDescriptor &attr) {
+        AttributeData data;
+        data.reserve(attr.fieldCount);
+        for (uint32_t i = attr.firstField; i < attr.firstField + attr.fieldCount; i++) {
+            const SceneFieldDescriptor &field = table.fields[i];
+            switch (field.type) {
+                case VecF:
+                    data[field.key] = AttrData(std::vector<float>(table.floats + field.index,
+                                                                  table.floats + field.index + field.count));
+                    break;
+                case VecI:
+                    data[field.key] = AttrData(std::vector<int>(table.ints + field.index,
+                                                                table.ints + field.index + field.count));
+                    break;
+                case Float:
+                    data[field.key] = AttrData(table.floats[field.index]);
+                    break;
+                case Int:
+                    data[field.key] = AttrData(table.ints[field.index]);
+                    break;
+                case String:
+                    data[field.key] = AttrData(std::string(table.strings[field.index]));
+                    break;
+                default:
+                    break;
+            }
+        }
+        return data;
+    }
+
+    void Scene::addObjects(const SceneTable &table) {
+        std::vector<GameObject *> objects(table.objectCount, nullptr);
+        for (size_t i = 0; i < table.objectCount; i++) {
+            const SceneObjectDescriptor &desc = table.objects[i];
+            if (desc.parent >= 0 && objects[desc.parent] == nullptr) {
+                continue; // its parent's prefab was not found
+            }
+            const SceneAttributeDescriptor *attrs = table.attributes + desc.firstAttribute;
+            GameObject *object;
+            if (desc.prefab != nullptr) {
+                PrefabOverrides overrides;
+                for (uint32_t a = 0; a < desc.attributeCount; a++) {
+                    if (attrs[a].kind == SceneAttributeKind::Override) {
+                        overrides[attrs[a].id] = tableData(table, attrs[a]);
+                    }
+                }
+                object = engine->instantiate(desc.prefab, desc.name, overrides);
+                if (object == nullptr) {
+                    continue;
+                }
+            } else {
+                object = new GameObject(desc.name);
+            }
+            for (uint32_t a = 0; a < desc.attributeCount; a++) {
+                const SceneAttributeDescriptor &attr = attrs[a];
+                if (attr.kind == SceneAttributeKind::Builtin) {
+                    object->addAttribute(new Attribute(engine, attr.id, tableData(table, attr)));
+                } else if (attr.kind == SceneAttributeKind::Script) {
+                    ScriptInterface *script = attr.script >= 0 ? engine->dispatchScript((uint32_t) attr.script, object)
+                                                               : engine->dispatchScript(attr.id, object);
+                    object->addAttribute(new Attribute(script, tableData(table, attr), attr.id));
+                }
+            }
+            objects[i] = object;
+            if (desc.parent < 0) {
+                addObject(object);
+            } else {
+                objects[desc.parent]->addObject(object);
+            }
+        }
+    }
+
+    static const uint32_t SNAPSHOT_MAGIC = 0x324e534a; // "JSN2"
+
+    static void hashBytes(uint64_t &hash, const void *data, size_t size) {
+        // FNV-1a
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ ((const uint8_t *) data)[i]) * 0x100000001b3ull;
+        }
+    }
+
+    static void hashString(uint64_t &hash, const std::string &str) {
+        hashBytes(hash, str.data(), str.size() + 1); // with the terminator, so "ab" "c" != "a" "bc"
+    }
+
+    // every object and the components collectSlots takes state from, in the same order, with the
+    // nesting included
+    static void hashLayout(uint64_t &hash, const std::vector<GameObject *> &objects) {
+        for (auto object: objects) {
+            hashString(hash, object->name);
+            for (auto attr: object->attributes) {
+                if (attr->isScript ? attr->script != nullptr : attr->builtin != nullptr) {
+                    hashString(hash, attr->id);
+                    hashString(hash, attr->scriptName);
+                }
+            }
+            hashBytes(hash, "(", 1);
+            hashLayout(hash, object->children);
+            hashBytes(hash, ")", 1);
+        }
+    }
+
+    static uint64_t layoutHash(const std::vector<GameObject *> &objects) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hashLayout(hash, objects);
+        return hash;
+    }
+
+    static void saveSlot(AttributeInterface *builtin, ScriptInterface *script, StateWriter &out) {
+        if (builtin != nullptr) {
+            builtin->saveState(out);
+        } else {
+            script->saveState(out);
+        }
+    }
+
+    static void loadSlot(AttributeInterface *builtin, ScriptInterface *script, StateReader &in) {
+        if (builtin != nullptr) {
+            builtin->loadState(in);
+        } else {
+            script->loadState(in);
+        }
+    }
+
+    void Scene::collectSlots(const std::vector<GameObject *> &objects) {
+        for (auto object: objects) {
+            for (auto attr: object->attributes) {
+                if (attr->isScript && attr->script != nullptr) {
+                    stateSlots.push_back({nullptr, attr->script, 0, 0});
+                } else if (!attr->isScript && attr->builtin != nullptr) {
+                    stateSlots.push_back({attr->builtin, nullptr, 0, 0});
+                }
+            }
+            collectSlots(object->children);
+        }
+    }
+
+    void Scene::captureBaseline() {
+        stateSlots.clear();
+        baseline.clear();
+        collectSlots(children);
+        layout = layoutHash(children);
+        StateWriter out(baseline);
+        for (auto &slot: stateSlots) {
+            slot.offset = baseline.size();
+            saveSlot(slot.builtin, slot.script, out);
+            slot.size = baseline.size() - slot.offset;
+        }
+    }
+
+    SceneSnapshot Scene::snapshot() {
+        // layout: magic, slot count, layout hash, bitmap of changed slots, then the size and state of
+        // every changed slot
+        SceneSnapshot snap;
+        size_t bitmapSize = (stateSlots.size() + 7) / 8;
+        snap.data.reserve(16 + bitmapSize + baseline.size());
+        StateWriter out(snap.data);
+        out.write(SNAPSHOT_MAGIC);
+        out.write((uint32_t) stateSlots.size());
+        out.write(layout);
+        size_t bitmapAt = snap.data.size();
+        snap.data.resize(bitmapAt + bitmapSize, 0);
+
+        for (size_t i = 0; i < stateSlots.size(); i++) {
+            const auto &slot = stateSlots[i];
+            size_t sizeAt = snap.data.size();
+            out.write((uint32_t) 0);
+            size_t start = snap.data.size();
+            saveSlot(slot.builtin, slot.script, out);
+            size_t size = snap.data.size() - start;
+            if (size == slot.size && memcmp(snap.data.data() + start, baseline.data() + slot.offset, size) == 0) {
+                snap.data.resize(sizeAt);
+            } else {
+                uint32_t size32 = (uint32_t) size;
+                memcpy(snap.data.data() + sizeAt, &size32, sizeof(size32));
+                snap.data[bitmapAt + i / 8] |= (uint8_t) (1 << (i % 8));
+            }
+        }
+        return snap;
+    }
+
+    bool Scene::restore(const SceneSnapshot &snap) {
+        StateReader in(snap.data.data(), snap.data.size());
+        uint32_t magic, count;
+        uint64_t snapLayout;
+        if (!in.read(magic) || !in.read(count) || !in.read(snapLayout) || magic != SNAPSHOT_MAGIC ||
+            count != stateSlots.size() || snapLayout != layout) {
+            std::cerr << "Snapshot does not match scene '" << name << "'" << std::endl;
+            return false;
+        }
+        if (layoutHash(children) != layout) {
+            std::cerr << "Scene '" << name << "' changed since its baseline was captured" << std::endl;
+            return false;
+        }
+        size_t bitmapSize = (stateSlots.size() + 7) / 8;
+        if ((size_t) (in.end - in.cur) < bitmapSize) {
+            std::cerr << "Snapshot is truncated" << std::endl;
+            return false;
+        }
+        const uint8_t *bitmap = in.cur;
+        in.cur += bitmapSize;
+
+        // the sizes have to account for the whole buffer before anything is loaded
+        StateReader check = in;
+        for (size_t i = 0; i < stateSlots.size(); i++) {
+            if (!(bitmap[i / 8] & (1 << (i % 8)))) {
+                continue;
+            }
+            uint32_t size;
+            if (!check.read(size) || (size_t) (check.end - check.cur) < size) {
+                std::cerr << "Snapshot is truncated" << std::endl;
+                return false;
+            }
+            check.cur += size;
+        }
+        if (check.cur != check.end) {
+            std::cerr << "Snapshot has trailing data" << std::endl;
+            return false;
+        }
+
+        for (size_t i = 0; i < stateSlots.size(); i++) {
+            const auto &slot = stateSlots[i];
+            if (bitmap[i / 8] & (1 << (i % 8))) {
+                uint32_t size;
+                in.read(size);
+                StateReader state(in.cur, size);
+                loadSlot(slot.builtin, slot.script, state);
+                in.cur += size;
+                if (state.failed || state.cur != state.end) {
+                    std::cerr << "Component " << i << " of scene '" << name
+                              << "' did not read back the state it saved" << std::endl;
+                    return false;
+                }
+            } else {
+                StateReader base(baseline.data() + slot.offset, slot.size);
+                loadSlot(slot.builtin, slot.script, base);
+            }
+        }
+        return true;
+    }
+
+    void Scene::reset() {
+        for (const auto &slot: stateSlots) {
+            StateReader base(baseline.data() + slot.offset, slot.size);
+            loadSlot(slot.builtin, slot.script, base);
+        }
+    }
+
 }
\ No newline at end of file
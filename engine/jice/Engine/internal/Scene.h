@@ -10,6 +10,60 @@ namespace jice {
         Dimension3D
     };
 
+    // Component state of a whole scene in one contiguous buffer. Only components that differ from
+    // the scene's baseline (its state right after Setup) are stored, everything else is taken from
+    // the baseline on restore.
+    class SceneSnapshot {
+    public:
+        std::vector<uint8_t> data;
+
+        [[nodiscard]] bool empty() const {
+            return data.empty();
+        }
+    };
+
+    // A scene jicc generated as constant tables instead of code (content.scene_codegen = "tables"). Every
+    // table is static constexpr data, a string is a pointer to a literal and a value an index into one of
+    // the constant pools, so nothing in them runs at startup.
+    struct SceneFieldDescriptor {
+        const char *key;
+        AttrDataType type;
+        uint32_t index; // into floats, ints or strings
+        uint32_t count; // elements, for VecF and VecI
+    };
+
+    enum class SceneAttributeKind : uint8_t {
+        Builtin,
+        Script,
+        Override // prefab overrides for the builtin id or script location in id
+    };
+
+    struct SceneAttributeDescriptor {
+        SceneAttributeKind kind;
+        const char *id; // builtin id or script location
+        int32_t script; // id in the engine's script table, -1 = dispatched by name
+        uint32_t firstField;
+        uint32_t fieldCount;
+    };
+
+    struct SceneObjectDescriptor {
+        const char *name;
+        const char *prefab; // nullptr for a plain object
+        int32_t parent; // index of an earlier object, -1 = the scene itself
+        uint32_t firstAttribute;
+        uint32_t attributeCount;
+    };
+
+    struct SceneTable {
+        const SceneObjectDescriptor *objects; // parents before their children
+        size_t objectCount;
+        const SceneAttributeDescriptor *attributes;
+        const SceneFieldDescriptor *fields;
+        const float *floats;
+        const int *ints;
+        const char *const *strings;
+    };
+
     class Scene : public ObjectInterface {
     public:
         Engine *engine;
@@ -21,6 +75,37 @@ namespace jice {
         virtual void Setup();
 
         virtual void Update();
+
+        // creates the objects of a jicc generated table, in order
+        void addObjects(const SceneTable &table);
+
+        // records the current state as the baseline that snapshots are delta encoded against,
+        // Setup calls this once all components and scripts are set up
+        void captureBaseline();
+
+        SceneSnapshot snapshot();
+
+        // fails if the snapshot was taken from a different scene layout, if objects or components were
+        // added or removed since captureBaseline, or if a component reads back a different amount of
+        // state than it saved. Slots before the one that failed are already restored.
+        bool restore(const SceneSnapshot &snap);
+
+        // back to the baseline, without reconstructing the scene
+        void reset();
+
+    private:
+        struct StateSlot {
+            AttributeInterface *builtin;
+            ScriptInterface *script;
+            size_t offset; // into baseline
+            size_t size;
+        };
+
+        std::vector<StateSlot> stateSlots;
+        std::vector<uint8_t> baseline;
+        uint64_t layout = 0; // layoutHash of the objects when the baseline was captured
+
+        void collectSlots(const std::vector<GameObject *> &objects);
     };
 
-}
\ No newline at end of file
+}
@@ -19,4 +19,10 @@ namespace jice {
         return {};
     }
 
+    void ScriptInterface::saveState(StateWriter &out) {
+    }
+
+    void ScriptInterface::loadState(StateReader &in) {
+    }
+
 }
\ No newline at end of file
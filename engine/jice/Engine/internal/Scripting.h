@@ -5,6 +5,10 @@
 
 namespace jice {
 
+    class StateWriter;
+
+    class StateReader;
+
     class GameObject;
 
     class Engine;
@@ -21,6 +25,11 @@ namespace jice {
         virtual void Update();
 
         virtual std::vector<std::string> getDependencies();
+
+        // override these to have the script's state included in scene snapshots
+        virtual void saveState(StateWriter &out);
+
+        virtual void loadState(StateReader &in);
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "ShaderCache.h"
+#include "AssetPack.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <filesystem>
+
+namespace jice {
+
+    static const uint32_t SHADER_BINARY_MAGIC = 0x4248534a; // "JSHB"
+
+    static std::string glString(GLenum name) {
+        const GLubyte *str = glGetString(name);
+        return str != nullptr ? (const char *) str : "";
+    }
+
+    // from GL_KHR_parallel_shader_compile, glad may not have been generated with it
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+    typedef void (*MaxShaderCompilerThreadsFn)(GLuint count);
+
+    static GLuint issueStage(GLenum type, const std::string &source) {
+        GLuint shader = glCreateShader(type);
+        const GLchar *src = source.c_str();
+        glShaderSource(shader, 1, &src, nullptr);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    static bool stageCompiled(GLenum type, GLuint shader) {
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (ok != GL_TRUE) {
+            GLint length = 0;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+            std::string log(length > 0 ? length : 1, '\0');
+            glGetShaderInfoLog(shader, (GLsizei) log.size(), nullptr, log.data());
+            std::cerr << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader: "
+                      << log << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void ShaderCache::open(const std::string &cacheDir) {
+        if (glfwExtensionSupported("GL_KHR_parallel_shader_compile")) {
+            auto maxThreads = (MaxShaderCompilerThreadsFn) glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+            if (maxThreads != nullptr) {
+                maxThreads(0xFFFFFFFF); // let the driver pick
+                parallel = true;
+            }
+        }
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (formats <= 0) {
+            std::cout << "Shader cache disabled, the driver has no program binary formats" << std::endl;
+            return;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDir, ec);
+        if (ec) {
+            std::cerr << "Failed to create shader cache '" << cacheDir << "'" << std::endl;
+            return;
+        }
+        dir = cacheDir;
+        // a driver update changes this, which invalidates every binary made by the old one
+        driver = glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION);
+        enabled = true;
+    }
+
+    std::string ShaderCache::pathFor(uint64_t key) const {
+        std::ostringstream name;
+        name << dir << "/" << std::hex << key << ".bin";
+        return name.str();
+    }
+
+    bool ShaderCache::load(const std::string &path, GLuint &program) const {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return false;
+        }
+        uint32_t header[3]; // magic, format, length
+        if (!in.read((char *) header, sizeof(header)) || header[0] != SHADER_BINARY_MAGIC) {
+            return false;
+        }
+        // a corrupt or foreign file could claim any length, it can't be longer than the file itself
+        std::error_code ec;
+        uintmax_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec || header[2] > fileSize - sizeof(header)) {
+            return false;
+        }
+        std::vector<char> binary(header[2]);
+        if (!in.read(binary.data(), (std::streamsize) binary.size())) {
+            return false;
+        }
+        program = glCreateProgram();
+        glProgramBinary(program, header[1], binary.data(), (GLsizei) binary.size());
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (ok != GL_TRUE) {
+            glDeleteProgram(program);
+            program = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void ShaderCache::store(const std::string &path, GLuint program) const {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            return;
+        }
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+        // written next to the target and renamed, so a crash never leaves a half written binary behind
+        std::string tmp = path + ".tmp";
+        std::ofstream out(tmp, std::ios::binary);
+        uint32_t header[3] = {SHADER_BINARY_MAGIC, format, (uint32_t) length};
+        out.write((const char *) header, sizeof(header));
+        out.write(binary.data(), (std::streamsize) binary.size());
+        out.close();
+        std::error_code ec;
+        if (out.fail()) {
+            // a short write, e.g. on a full disk, must not become a cache entry
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+        std::filesystem::rename(tmp, path, ec);
+    }
+
+    EogllShaderProgram *ShaderCache::link(const std::string &vert, const std::string &frag) {
+        PendingProgram pending = begin("", vert, frag);
+        return finish(pending);
+    }
+
+    PendingProgram ShaderCache::begin(const std::string &name, const std::string &vert, const std::string &frag) {
+        PendingProgram pending;
+        pending.name = name;
+        if (enabled) {
+            pending.path = pathFor(fnv1a64(vert + '\0' + frag + '\0' + driver));
+            if (load(pending.path, pending.program)) {
+                hits++;
+                pending.cached = true;
+                return pending;
+            }
+            misses++;
+        }
+        pending.vs = issueStage(GL_VERTEX_SHADER, vert);
+        pending.fs = issueStage(GL_FRAGMENT_SHADER, frag);
+        pending.program = glCreateProgram();
+        glAttachShader(pending.program, pending.vs);
+        glAttachShader(pending.program, pending.fs);
+        // eogllLinkProgram can't be used here, the retrievable hint has to be set before linking
+        if (enabled) {
+            glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        // linking a program whose stages failed just fails too, finish reports the stage's log
+        glLinkProgram(pending.program);
+        return pending;
+    }
+
+    bool ShaderCache::isDone(const PendingProgram &pending) const {
+        if (pending.cached || !parallel) {
+            return true;
+        }
+        GLint done = GL_FALSE;
+        glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+    EogllShaderProgram *ShaderCache::finish(PendingProgram &pending) {
+        GLuint program = pending.program;
+        pending.program = 0;
+        if (!pending.cached) {
+            bool ok = stageCompiled(GL_VERTEX_SHADER, pending.vs) && stageCompiled(GL_FRAGMENT_SHADER, pending.fs);
+            glDetachShader(program, pending.vs);
+            glDetachShader(program, pending.fs);
+            glDeleteShader(pending.vs);
+            glDeleteShader(pending.fs);
+            GLint linked = GL_FALSE;
+            if (ok) {
+                glGetProgramiv(program, GL_LINK_STATUS, &linked);
+                if (linked != GL_TRUE) {
+                    GLint length = 0;
+                    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+                    std::string log(length > 0 ? length : 1, '\0');
+                    glGetProgramInfoLog(program, (GLsizei) log.size(), nullptr, log.data());
+                    std::cerr << "Failed to link shader program: " << log << std::endl;
+                }
+            }
+            if (linked != GL_TRUE) {
+                glDeleteProgram(program);
+                return nullptr;
+            }
+            if (enabled) {
+                store(pending.path, program);
+            }
+        }
+        // eogll has no way to wrap a program it didn't link, the id has to be its only field
+        static_assert(sizeof(EogllShaderProgram) == sizeof(unsigned int),
+                      "EogllShaderProgram has fields ShaderCache doesn't set");
+        auto *shader = new EogllShaderProgram{};
+        shader->id = program;
+        return shader;
+    }
+
+    void ShaderCache::release(EogllShaderProgram *shader) {
+        if (shader == nullptr) {
+            return;
+        }
+        glDeleteProgram(shader->id);
+        delete shader;
+    }
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+#include <eogll.h>
+
+namespace jice {
+
+    // A program jicc found at build time, variants included. Tables of these are sorted by name.
+    struct ShaderProgramDescriptor {
+        const char *name; // e.g. "shaders/default" or "shaders/default@fog"
+        const char *vert; // asset names of the preprocessed stages
+        const char *frag;
+    };
+
+    // A program whose compile and link have been issued but not waited on, see ShaderCache::begin
+    struct PendingProgram {
+        std::string name;
+        std::string path; // where the binary is cached, empty if the cache is disabled
+        unsigned int program = 0;
+        unsigned int vs = 0;
+        unsigned int fs = 0;
+        bool cached = false; // loaded from a binary, nothing left to wait for
+    };
+
+    // Keeps linked programs on disk with glGetProgramBinary, so later runs skip compiling them.
+    // Binaries are keyed by a hash of both sources and the driver, and one the driver rejects is
+    // simply compiled again and replaced.
+    class ShaderCache {
+    public:
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+
+        // needs a current GL context. Does nothing (and every link compiles) if the driver has no binary formats
+        void open(const std::string &dir);
+
+        [[nodiscard]] bool isEnabled() const { return enabled; }
+
+        // true if the driver compiles in the background (GL_KHR_parallel_shader_compile)
+        [[nodiscard]] bool isParallel() const { return parallel; }
+
+        // nullptr if the sources don't compile or link
+        EogllShaderProgram *link(const std::string &vert, const std::string &frag);
+
+        // Issues the compile and link without asking GL about the result, so many programs can be
+        // compiling at once. Hand it to finish once isDone says so.
+        PendingProgram begin(const std::string &name, const std::string &vert, const std::string &frag);
+
+        // never blocks with parallel compiles, always true without them
+        [[nodiscard]] bool isDone(const PendingProgram &pending) const;
+
+        // nullptr if the sources didn't compile or link, blocks if the program is not done yet
+        EogllShaderProgram *finish(PendingProgram &pending);
+
+        // programs from link and finish are allocated here rather than by eogll, so they are freed
+        // with this instead of eogllDeleteProgram
+        static void release(EogllShaderProgram *shader);
+
+    private:
+        std::string dir;
+        std::string driver; // vendor, renderer and version
+        bool enabled = false;
+        bool parallel = false;
+
+        [[nodiscard]] std::string pathFor(uint64_t key) const;
+
+        bool load(const std::string &path, unsigned int &program) const;
+
+        void store(const std::string &path, unsigned int program) const;
+    };
+
+}
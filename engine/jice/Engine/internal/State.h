@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace jice {
+
+    // appends raw component state to a byte buffer, see Scene::snapshot
+    class StateWriter {
+    public:
+        std::vector<uint8_t> &buffer;
+
+        explicit StateWriter(std::vector<uint8_t> &buffer) : buffer(buffer) {}
+
+        void writeBytes(const void *src, size_t size) {
+            size_t at = buffer.size();
+            buffer.resize(at + size);
+            memcpy(buffer.data() + at, src, size);
+        }
+
+        template<typename T>
+        void write(const T &value) {
+            static_assert(std::is_trivially_copyable<T>::value, "state must be trivially copyable");
+            writeBytes(&value, sizeof(T));
+        }
+
+        void writeString(const std::string &str) {
+            write<uint32_t>((uint32_t) str.size());
+            writeBytes(str.data(), str.size());
+        }
+    };
+
+    // reads state written by StateWriter back, in the same order
+    class StateReader {
+    public:
+        const uint8_t *cur;
+        const uint8_t *end;
+        bool failed = false; // a read ran past the end
+
+        StateReader(const uint8_t *data, size_t size) : cur(data), end(data + size) {}
+
+        bool readBytes(void *dst, size_t size) {
+            if ((size_t) (end - cur) < size) {
+                cur = end;
+                failed = true;
+                return false;
+            }
+            memcpy(dst, cur, size);
+            cur += size;
+            return true;
+        }
+
+        template<typename T>
+        bool read(T &value) {
+            static_assert(std::is_trivially_copyable<T>::value, "state must be trivially copyable");
+            return readBytes(&value, sizeof(T));
+        }
+
+        bool readString(std::string &str) {
+            uint32_t size;
+            if (!read(size) || (size_t) (end - cur) < size) {
+                cur = end;
+                failed = true;
+                return false;
+            }
+            str.assign((const char *) cur, size);
+            cur += size;
+            return true;
+        }
+    };
+
+}
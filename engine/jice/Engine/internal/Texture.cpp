@@ -0,0 +1,53 @@
+#include "Texture.h"
+
+#include <eogll.h>
+
+namespace jice {
+
+    Texture *Texture::create(const DecodedImage &image) {
+        auto *texture = new Texture();
+        texture->upload(image);
+        return texture;
+    }
+
+    void Texture::upload(const DecodedImage &image) {
+        if (id == 0) {
+            glGenTextures(1, &id);
+        }
+        glBindTexture(GL_TEXTURE_2D, id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        const uint8_t *pixels = image.pixels.data();
+        bytes = 0;
+        for (int level = 0; level < image.levels; level++) {
+            int w = mipSize(image.width, level);
+            int h = mipSize(image.height, level);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            pixels += (size_t) w * h * 4;
+            bytes += (size_t) w * h * 4;
+        }
+        // without this a texture with fewer levels than a full chain would be incomplete
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        width = image.width;
+        height = image.height;
+        levels = image.levels;
+        premultiplied = image.premultiplied;
+    }
+
+    void Texture::bind() const {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, id);
+    }
+
+    void Texture::destroy() {
+        if (id != 0) {
+            glDeleteTextures(1, &id);
+            id = 0;
+        }
+        bytes = 0;
+    }
+
+}
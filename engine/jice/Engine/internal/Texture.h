@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Engine/util/Image.h"
+
+namespace jice {
+
+    // A GL texture owned by the engine. The object stays put for its whole life, so code holding a
+    // Texture* keeps working when the GL texture behind it is re-uploaded.
+    class Texture {
+    public:
+        unsigned int id = 0;
+        int width = 0;
+        int height = 0;
+        int levels = 1;
+        bool premultiplied = false; // draw with glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA)
+        size_t bytes = 0; // estimated GPU memory
+
+        // render thread only
+        static Texture *create(const DecodedImage &image);
+
+        // render thread only, replaces the contents in place
+        void upload(const DecodedImage &image);
+
+        void bind() const;
+
+        void destroy();
+    };
+
+    // a texture in Engine's cache, lastUsed is the frame it was last drawn in
+    struct TextureEntry {
+        Texture *texture = nullptr;
+        uint64_t lastUsed = 0;
+    };
+
+    struct TextureStats {
+        uint64_t hits = 0; // draws that found their texture resident
+        uint64_t misses = 0; // draws that had to wait for a load
+        uint64_t evictions = 0;
+        size_t residentCount = 0;
+        size_t residentBytes = 0;
+
+        [[nodiscard]] double hitRate() const {
+            return hits + misses == 0 ? 1.0 : (double) hits / (double) (hits + misses);
+        }
+    };
+
+}
@@ -0,0 +1,110 @@
+#include "Compression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <lz4.h>
+#include <zstd.h>
+
+namespace jice {
+
+    template<typename T>
+    static T readLE(const uint8_t *p) {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    bool isCompressed(AssetSpan data) {
+        return data.size() >= JCMP_HEADER_SIZE && readLE<uint32_t>(data.data()) == JCMP_MAGIC;
+    }
+
+    bool decompressAsset(const Asset &in, Asset &out, std::string &error) {
+        AssetSpan data = in.getData();
+        if (!isCompressed(data)) {
+            error = "not a jcmp asset";
+            return false;
+        }
+        uint16_t version = readLE<uint16_t>(data.data() + 4);
+        auto codec = (CompressionCodec) readLE<uint16_t>(data.data() + 6);
+        uint32_t chunkSize = readLE<uint32_t>(data.data() + 8);
+        uint32_t chunkCount = readLE<uint32_t>(data.data() + 12);
+        uint64_t rawSize = readLE<uint64_t>(data.data() + 16);
+        if (version != JCMP_VERSION) {
+            error = "unsupported jcmp version " + std::to_string(version);
+            return false;
+        }
+        if (codec != CompressionCodec::LZ4 && codec != CompressionCodec::Zstd) {
+            error = "unsupported jcmp codec " + std::to_string((int) codec);
+            return false;
+        }
+        if (chunkSize == 0 || chunkCount != (rawSize + chunkSize - 1) / chunkSize ||
+            data.size() < JCMP_HEADER_SIZE + (uint64_t) chunkCount * 4) {
+            error = "bad jcmp header";
+            return false;
+        }
+        // rawSize is only trusted once every chunk is in the file and could decode to its share of it,
+        // so a corrupt header fails here instead of allocating whatever it claims
+        const uint8_t *table = data.data() + JCMP_HEADER_SIZE;
+        uint64_t available = data.size() - JCMP_HEADER_SIZE - (uint64_t) chunkCount * 4;
+        uint64_t claimed = 0;
+        for (uint32_t i = 0; i < chunkCount; i++) {
+            uint32_t packed = readLE<uint32_t>(table + i * 4);
+            uint64_t expected = std::min<uint64_t>(chunkSize, rawSize - (uint64_t) i * chunkSize);
+            // lz4 expands at most 255:1, zstd at most a 128 KiB RLE block per 4 bytes
+            uint64_t ratio = codec == CompressionCodec::LZ4 ? 255 : 32 * 1024;
+            if (packed > available - claimed || expected > (uint64_t) packed * ratio) {
+                error = "bad jcmp chunk table";
+                return false;
+            }
+            // jicc's zstd frames record their size, which has to match too
+            const uint8_t *src = table + (size_t) chunkCount * 4 + claimed;
+            if (codec == CompressionCodec::Zstd && ZSTD_getFrameContentSize(src, packed) != expected) {
+                error = "bad jcmp chunk table";
+                return false;
+            }
+            claimed += packed;
+        }
+
+        std::shared_ptr<uint8_t> buffer(new uint8_t[rawSize + 1], std::default_delete<uint8_t[]>());
+        buffer.get()[rawSize] = 0;
+        const uint8_t *sizes = data.data() + JCMP_HEADER_SIZE;
+        size_t offset = JCMP_HEADER_SIZE + (size_t) chunkCount * 4;
+        uint64_t written = 0;
+        ZSTD_DCtx *zstd = codec == CompressionCodec::Zstd ? ZSTD_createDCtx() : nullptr;
+        bool ok = true;
+        for (uint32_t i = 0; i < chunkCount && ok; i++) {
+            uint32_t packed = readLE<uint32_t>(sizes + i * 4);
+            auto expected = (size_t) std::min<uint64_t>(chunkSize, rawSize - written);
+            if (offset + packed > data.size()) {
+                error = "truncated jcmp chunk";
+                ok = false;
+                break;
+            }
+            const uint8_t *src = data.data() + offset;
+            uint8_t *dst = buffer.get() + written;
+            size_t produced;
+            if (codec == CompressionCodec::LZ4) {
+                int result = LZ4_decompress_safe((const char *) src, (char *) dst, (int) packed, (int) expected);
+                produced = result < 0 ? 0 : (size_t) result;
+            } else {
+                produced = ZSTD_decompressDCtx(zstd, dst, expected, src, packed);
+                if (ZSTD_isError(produced)) {
+                    produced = 0;
+                }
+            }
+            if (produced != expected) {
+                error = "corrupt jcmp chunk " + std::to_string(i);
+                ok = false;
+            }
+            offset += packed;
+            written += expected;
+        }
+        ZSTD_freeDCtx(zstd);
+        if (!ok) {
+            return false;
+        }
+        out = Asset(std::shared_ptr<const uint8_t>(buffer), rawSize);
+        return true;
+    }
+
+}
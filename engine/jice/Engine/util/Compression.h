@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "Engine/internal/Asset.h"
+
+namespace jice {
+
+    // .jcmp, written by jicc for assets with "compression" set in their .jmeta.
+    // little endian, 24 byte header, then the compressed size of every chunk as a u32, then the chunks
+    //   u32 magic "JCMP", u16 version, u16 codec, u32 chunk size, u32 chunk count, u64 raw size
+    // every chunk is compressed on its own, so they are decoded one at a time straight into the output
+    const uint32_t JCMP_MAGIC = 0x504d434a;
+    const uint16_t JCMP_VERSION = 1;
+    const uint32_t JCMP_HEADER_SIZE = 24;
+
+    enum class CompressionCodec : uint16_t {
+        LZ4 = 1,
+        Zstd = 2,
+    };
+
+    bool isCompressed(AssetSpan data);
+
+    // the result keeps a null byte after the data, like compiled assets do. safe to call from any thread
+    bool decompressAsset(const Asset &in, Asset &out, std::string &error);
+
+}
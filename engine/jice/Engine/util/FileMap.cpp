@@ -0,0 +1,111 @@
+#include "FileMap.h"
+
+#include <filesystem>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace jice {
+
+    // something non-null to hand out for empty files, which cannot be mapped
+    static const uint8_t emptyFile[1] = {0};
+
+#if defined(_WIN32)
+    std::shared_ptr<const uint8_t> mapFile(const std::string &path, size_t &size) {
+        size = 0;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            return nullptr;
+        }
+        if (fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return {emptyFile, [](const uint8_t *) {}};
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return nullptr;
+        }
+        // the view keeps the mapping alive on its own
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            return nullptr;
+        }
+        size = (size_t) fileSize.QuadPart;
+        return {(const uint8_t *) view, [](const uint8_t *p) { UnmapViewOfFile(p); }};
+    }
+
+    std::string executableDir() {
+        wchar_t path[MAX_PATH];
+        DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+        if (length == 0 || length == MAX_PATH) {
+            return "";
+        }
+        return std::filesystem::path(path, path + length).parent_path().string();
+    }
+#else
+    std::shared_ptr<const uint8_t> mapFile(const std::string &path, size_t &size) {
+        size = 0;
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return nullptr;
+        }
+        if (st.st_size == 0) {
+            close(fd);
+            return {emptyFile, [](const uint8_t *) {}};
+        }
+        size_t length = (size_t) st.st_size;
+        void *view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping stays valid after the descriptor is closed
+        close(fd);
+        if (view == MAP_FAILED) {
+            return nullptr;
+        }
+        size = length;
+        return {(const uint8_t *) view, [length](const uint8_t *p) { munmap((void *) p, length); }};
+    }
+
+    std::string executableDir() {
+        std::error_code ec;
+#if defined(__APPLE__)
+        char path[4096];
+        uint32_t length = sizeof(path);
+        if (_NSGetExecutablePath(path, &length) != 0) {
+            return "";
+        }
+        std::filesystem::path exe = std::filesystem::canonical(path, ec);
+#else
+        std::filesystem::path exe = std::filesystem::read_symlink("/proc/self/exe", ec);
+#endif
+        if (ec) {
+            return "";
+        }
+        return exe.parent_path().string();
+    }
+#endif
+
+}
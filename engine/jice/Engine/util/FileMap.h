@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace jice {
+
+    // maps a whole file read-only, the mapping is released with the last copy of the returned pointer
+    // returns nullptr if the file could not be opened or mapped (an empty file maps to an empty buffer)
+    std::shared_ptr<const uint8_t> mapFile(const std::string &path, size_t &size);
+
+    // the folder the running executable is in, empty if it can't be found
+    std::string executableDir();
+
+}
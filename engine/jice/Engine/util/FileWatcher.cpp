@@ -0,0 +1,101 @@
+#include "FileWatcher.h"
+
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace jice {
+
+#if defined(__linux__)
+    FileWatcher::~FileWatcher() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    bool FileWatcher::watch(const std::string &dir) {
+        if (fd < 0) {
+            fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (fd < 0) {
+                std::cerr << "Failed to start inotify" << std::endl;
+                return false;
+            }
+        }
+        root = dir;
+        addDir("");
+        std::error_code ec;
+        for (const auto &entry: fs::recursive_directory_iterator(dir, ec)) {
+            if (entry.is_directory()) {
+                addDir(fs::relative(entry.path(), dir).generic_string());
+            }
+        }
+        return true;
+    }
+
+    void FileWatcher::addDir(const std::string &rel) {
+        std::string path = rel.empty() ? root : root + "/" + rel;
+        // editors usually save by writing a temporary file and renaming it over the old one
+        int wd = inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd < 0) {
+            std::cerr << "Failed to watch '" << path << "'" << std::endl;
+            return;
+        }
+        dirs[wd] = rel;
+    }
+
+    std::vector<std::string> FileWatcher::poll() {
+        std::vector<std::string> changed;
+        if (fd < 0) {
+            return changed;
+        }
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break; // EAGAIN, nothing left
+            }
+            for (char *p = buffer; p < buffer + length;) {
+                auto *event = (inotify_event *) p;
+                p += sizeof(inotify_event) + event->len;
+                auto dir = dirs.find(event->wd);
+                if (dir == dirs.end() || event->len == 0) {
+                    continue;
+                }
+                std::string rel = dir->second.empty() ? event->name : dir->second + "/" + event->name;
+                if (event->mask & IN_ISDIR) {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        addDir(rel);
+                    }
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    if (std::find(changed.begin(), changed.end(), rel) == changed.end()) {
+                        changed.push_back(rel);
+                    }
+                }
+            }
+        }
+        return changed;
+    }
+#else
+    FileWatcher::~FileWatcher() = default;
+
+    bool FileWatcher::watch(const std::string &dir) {
+        std::cerr << "Watching '" << dir << "' is only supported on Linux" << std::endl;
+        return false;
+    }
+
+    void FileWatcher::addDir(const std::string &rel) {}
+
+    std::vector<std::string> FileWatcher::poll() {
+        return {};
+    }
+#endif
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace jice {
+
+    // Reports files that were written under a directory. Only implemented with inotify on Linux,
+    // everywhere else watch() returns false and poll() never reports anything.
+    class FileWatcher {
+    public:
+        FileWatcher() = default;
+
+        FileWatcher(const FileWatcher &) = delete;
+
+        FileWatcher &operator=(const FileWatcher &) = delete;
+
+        ~FileWatcher();
+
+        // watches dir and everything below it, directories created later included
+        bool watch(const std::string &dir);
+
+        [[nodiscard]] bool isWatching() const { return fd >= 0; }
+
+        // never blocks. Paths of files finished being written since the last call, relative to dir,
+        // each reported once
+        std::vector<std::string> poll();
+
+    private:
+        int fd = -1;
+        std::string root;
+        std::unordered_map<int, std::string> dirs; // watch descriptor -> path relative to root
+
+        void addDir(const std::string &rel);
+    };
+
+}
@@ -0,0 +1,86 @@
+#include "Image.h"
+
+#include <cstring>
+
+// static, so this can never clash with the copy of stb_image inside eogll
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace jice {
+
+    template<typename T>
+    static T readLE(const uint8_t *p) {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    static bool readJtex(const Asset &asset, DecodedImage &out, std::string &error) {
+        AssetSpan data = asset.getData();
+        if (data.size() < JTEX_HEADER_SIZE) {
+            error = "truncated jtex header";
+            return false;
+        }
+        uint16_t version = readLE<uint16_t>(data.data() + 4);
+        auto format = (JtexFormat) readLE<uint16_t>(data.data() + 6);
+        int width = (int) readLE<uint32_t>(data.data() + 8);
+        int height = (int) readLE<uint32_t>(data.data() + 12);
+        int levels = (int) readLE<uint32_t>(data.data() + 16);
+        uint32_t flags = readLE<uint32_t>(data.data() + 20);
+        if (version != JTEX_VERSION) {
+            error = "unsupported jtex version " + std::to_string(version);
+            return false;
+        }
+        if (format != JtexFormat::RGBA8) {
+            error = "unsupported jtex format " + std::to_string((int) format);
+            return false;
+        }
+        if (width <= 0 || height <= 0 || levels <= 0 || levels > 32) {
+            error = "bad jtex dimensions";
+            return false;
+        }
+        size_t size = 0;
+        for (int level = 0; level < levels; level++) {
+            size += (size_t) mipSize(width, level) * mipSize(height, level) * 4;
+        }
+        if (data.size() < JTEX_HEADER_SIZE + size) {
+            error = "truncated jtex data";
+            return false;
+        }
+        out.width = width;
+        out.height = height;
+        out.levels = levels;
+        out.premultiplied = (flags & JTEX_PREMULTIPLIED) != 0;
+        out.pixels = AssetSpan(data.data() + JTEX_HEADER_SIZE, size);
+        out.source = asset;
+        return true;
+    }
+
+    bool decodeImage(const Asset &asset, DecodedImage &out, std::string &error) {
+        AssetSpan data = asset.getData();
+        if (data.size() >= 4 && readLE<uint32_t>(data.data()) == JTEX_MAGIC) {
+            return readJtex(asset, out, error);
+        }
+        int width, height, channels;
+        stbi_uc *pixels = stbi_load_from_memory(data.data(), (int) data.size(), &width, &height, &channels, 4);
+        if (pixels == nullptr) {
+            error = stbi_failure_reason();
+            return false;
+        }
+        size_t row = (size_t) width * 4;
+        out.width = width;
+        out.height = height;
+        out.levels = 1;
+        out.premultiplied = false;
+        out.storage.resize(row * height);
+        // flip while copying out, stb's global flip setting is not thread safe
+        for (int y = 0; y < height; y++) {
+            memcpy(out.storage.data() + row * (height - 1 - y), pixels + row * y, row);
+        }
+        stbi_image_free(pixels);
+        out.pixels = AssetSpan(out.storage.data(), out.storage.size());
+        return true;
+    }
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include "Engine/internal/Asset.h"
+
+namespace jice {
+
+    // .jtex, written by jicc's texture import so nothing has to be decoded at runtime.
+    // little endian, 32 byte header then every mip level largest first, each tightly packed with the
+    // first row at the bottom
+    //   u32 magic "JTEX", u16 version, u16 format, u32 width, u32 height, u32 levels, u32 flags, u64 reserved
+    const uint32_t JTEX_MAGIC = 0x5845544a;
+    const uint16_t JTEX_VERSION = 1;
+    const uint32_t JTEX_HEADER_SIZE = 32;
+
+    enum class JtexFormat : uint16_t {
+        RGBA8 = 0,
+    };
+
+    enum JtexFlags : uint32_t {
+        JTEX_PREMULTIPLIED = 1,
+    };
+
+    // size of mip level `level` of a width x height image, never smaller than 1x1
+    inline int mipSize(int size, int level) {
+        size >>= level;
+        return size > 0 ? size : 1;
+    }
+
+    // RGBA8 with the first row at the bottom (what GL expects). levels > 1 means the mip chain follows
+    // the base image back to back.
+    struct DecodedImage {
+        int width = 0;
+        int height = 0;
+        int levels = 1;
+        bool premultiplied = false;
+        AssetSpan pixels;
+        std::vector<uint8_t> storage; // owns pixels when they had to be decoded
+        Asset source; // owns pixels when they are read straight out of a .jtex
+
+        DecodedImage() = default;
+        DecodedImage(DecodedImage &&) = default;
+        DecodedImage &operator=(DecodedImage &&) = default;
+    };
+
+    // takes a .jtex without copying it, or decodes any format stb_image understands. safe to call from
+    // any thread
+    bool decodeImage(const Asset &asset, DecodedImage &out, std::string &error);
+
+}
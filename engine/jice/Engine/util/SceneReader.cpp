@@ -0,0 +1,321 @@
+#include "SceneReader.h"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace jice {
+
+    namespace {
+
+        using json = nlohmann::json;
+
+        // where in the scene file the parser is, the top of the stack decides what a value means
+        struct Frame {
+            enum Kind {
+                Root,
+                Data,
+                Content,
+                Object,
+                Children,
+                Overrides,
+                Attributes,
+                Attribute,
+                Fields,
+                Array,
+                Skip
+            };
+
+            Kind kind;
+            std::string key; // last key seen, for frames that are JSON objects
+            SceneFields *fields = nullptr; // Fields
+            SceneValue *value = nullptr; // Array
+        };
+
+        class SceneSax : public nlohmann::json_sax<json> {
+        public:
+            SceneReader &reader;
+            std::vector<Frame> frames;
+            std::vector<SceneObject> objects; // being read, innermost last
+
+            explicit SceneSax(SceneReader &reader) : reader(reader) {}
+
+            bool fail(const std::string &message) {
+                reader.error = message;
+                return false;
+            }
+
+            bool scalar(SceneValue value) {
+                if (frames.empty()) {
+                    return fail("Scene is not a JSON object!");
+                }
+                Frame &top = frames.back();
+                switch (top.kind) {
+                    case Frame::Root:
+                        if (value.type == SceneValue::Int && top.key == "engine_version") {
+                            reader.engineVersion = std::stoll(value.text);
+                        } else if (value.type == SceneValue::Int && top.key == "data_id") {
+                            reader.dataId = std::stoll(value.text);
+                        }
+                        return true;
+                    case Frame::Data:
+                        if (top.key == "name" && value.type == SceneValue::String) {
+                            reader.name = value.text;
+                            reader.hasName = true;
+                        } else if (top.key == "3d" && value.type == SceneValue::Bool) {
+                            reader.is3d = value.b;
+                        } else if (top.key == "content" && value.type != SceneValue::Null) {
+                            return fail("Scene content is not an array!");
+                        }
+                        return true;
+                    case Frame::Content:
+                    case Frame::Children:
+                        return fail("Object is not an object!");
+                    case Frame::Object: {
+                        SceneObject &object = objects.back();
+                        if (top.key == "id") {
+                            if (value.type != SceneValue::String) {
+                                return fail("Object id is not a string!");
+                            }
+                            object.id = value.text;
+                            object.hasId = true;
+                        } else if (top.key == "prefab" && value.type == SceneValue::String) {
+                            object.prefab = value.text;
+                        } else if (top.key == "overrides") {
+                            return fail("Prefab overrides is not an object!");
+                        } else if (top.key == "attributes") {
+                            return fail("Object attributes is not an array!");
+                        } else if (top.key == "children") {
+                            return fail("Object children is not an array!");
+                        }
+                        return true;
+                    }
+                    case Frame::Attributes:
+                        return fail("Attribute is not an object!");
+                    case Frame::Attribute: {
+                        SceneAttribute &attr = objects.back().attributes.back();
+                        if (value.type != SceneValue::String) {
+                            return true;
+                        }
+                        if (top.key == "type") {
+                            attr.type = value.text;
+                        } else if (top.key == "id") {
+                            attr.id = value.text;
+                        } else if (top.key == "location") {
+                            attr.location = value.text;
+                        }
+                        return true;
+                    }
+                    case Frame::Fields:
+                        (*top.fields)[top.key] = std::move(value);
+                        return true;
+                    case Frame::Array:
+                        top.value->items.push_back(std::move(value));
+                        return true;
+                    default:
+                        return true;
+                }
+            }
+
+            bool begin(bool object) {
+                if (frames.empty()) {
+                    if (!object) {
+                        return fail("Scene is not a JSON object!");
+                    }
+                    frames.push_back({Frame::Root});
+                    return true;
+                }
+                Frame &top = frames.back();
+                const std::string &key = top.key;
+                switch (top.kind) {
+                    case Frame::Root:
+                        if (object && key == "data") {
+                            reader.hasData = true;
+                            frames.push_back({Frame::Data});
+                            return true;
+                        }
+                        break;
+                    case Frame::Data:
+                        if (key == "content") {
+                            if (object) {
+                                return fail("Scene content is not an array!");
+                            }
+                            frames.push_back({Frame::Content});
+                            return true;
+                        }
+                        break;
+                    case Frame::Content:
+                    case Frame::Children:
+                        if (!object) {
+                            return fail("Object is not an object!");
+                        }
+                        objects.emplace_back();
+                        frames.push_back({Frame::Object});
+                        return true;
+                    case Frame::Object:
+                        if (key == "overrides") {
+                            if (!object) {
+                                return fail("Prefab overrides is not an object!");
+                            }
+                            objects.back().hasOverrides = true;
+                            frames.push_back({Frame::Overrides});
+                            return true;
+                        } else if (key == "attributes") {
+                            if (object) {
+                                return fail("Object attributes is not an array!");
+                            }
+                            frames.push_back({Frame::Attributes});
+                            return true;
+                        } else if (key == "children") {
+                            if (object) {
+                                return fail("Object children is not an array!");
+                            }
+                            frames.push_back({Frame::Children});
+                            return true;
+                        }
+                        break;
+                    case Frame::Attributes:
+                        if (!object) {
+                            return fail("Attribute is not an object!");
+                        }
+                        objects.back().attributes.emplace_back();
+                        frames.push_back({Frame::Attribute});
+                        return true;
+                    case Frame::Attribute:
+                        if (object && key == "data") {
+                            SceneAttribute &attr = objects.back().attributes.back();
+                            attr.hasData = true;
+                            frames.push_back({Frame::Fields, "", &attr.data});
+                            return true;
+                        }
+                        break;
+                    case Frame::Overrides:
+                        if (object) {
+                            frames.push_back({Frame::Fields, "", &objects.back().overrides[key]});
+                            return true;
+                        }
+                        break;
+                    case Frame::Fields: {
+                        SceneValue &value = (*top.fields)[key];
+                        value = SceneValue();
+                        if (!object) {
+                            value.type = SceneValue::Array;
+                            frames.push_back({Frame::Array, "", nullptr, &value});
+                            return true;
+                        }
+                        value.type = SceneValue::Object;
+                        break;
+                    }
+                    case Frame::Array: {
+                        SceneValue nested;
+                        nested.type = object ? SceneValue::Object : SceneValue::Array;
+                        top.value->items.push_back(std::move(nested));
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                // nothing in here is read
+                frames.push_back({Frame::Skip});
+                return true;
+            }
+
+            bool end() {
+                Frame::Kind kind = frames.back().kind;
+                frames.pop_back();
+                if (kind != Frame::Object) {
+                    return true;
+                }
+                SceneObject object = std::move(objects.back());
+                objects.pop_back();
+                if (frames.back().kind == Frame::Children) {
+                    objects.back().children.push_back(std::move(object));
+                } else if (reader.onObject) {
+                    reader.onObject(std::move(object));
+                }
+                return true;
+            }
+
+            bool null() override {
+                return scalar({});
+            }
+
+            bool boolean(bool val) override {
+                SceneValue value;
+                value.type = SceneValue::Bool;
+                value.b = val;
+                return scalar(std::move(value));
+            }
+
+            bool number_integer(number_integer_t val) override {
+                SceneValue value;
+                value.type = SceneValue::Int;
+                value.text = std::to_string(val);
+                return scalar(std::move(value));
+            }
+
+            bool number_unsigned(number_unsigned_t val) override {
+                SceneValue value;
+                value.type = SceneValue::Int;
+                value.text = std::to_string(val);
+                return scalar(std::move(value));
+            }
+
+            bool number_float(number_float_t val, const string_t &s) override {
+                SceneValue value;
+                value.type = SceneValue::Float;
+                value.text = s;
+                return scalar(std::move(value));
+            }
+
+            bool string(string_t &val) override {
+                SceneValue value;
+                value.type = SceneValue::String;
+                value.text = std::move(val);
+                return scalar(std::move(value));
+            }
+
+            bool binary(binary_t &val) override {
+                return scalar({});
+            }
+
+            bool start_object(std::size_t elements) override {
+                return begin(true);
+            }
+
+            bool key(string_t &val) override {
+                frames.back().key = std::move(val);
+                return true;
+            }
+
+            bool end_object() override {
+                return end();
+            }
+
+            bool start_array(std::size_t elements) override {
+                return begin(false);
+            }
+
+            bool end_array() override {
+                return end();
+            }
+
+            bool parse_error(std::size_t position, const std::string &last_token,
+                             const nlohmann::detail::exception &ex) override {
+                return fail(ex.what());
+            }
+        };
+
+    }
+
+    bool SceneReader::read(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            error = "Failed to open '" + path + "'";
+            return false;
+        }
+        SceneSax sax(*this);
+        // the stream is read through its buffer as it is parsed, the file is never loaded whole
+        return json::sax_parse(in, &sax) && error.empty();
+    }
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+namespace jice {
+
+    // A scene file (data_id 1) read straight into these, one object at a time, with no JSON document in
+    // between. Shared by jicc and the editor, which compile SceneReader.cpp in and link nlohmann_json;
+    // the Engine library itself has no JSON dependency.
+
+    // one attribute data value
+    struct SceneValue {
+        enum Type {
+            Null,
+            Bool,
+            Int,
+            Float,
+            String,
+            Array,
+            Object // contents are skipped, nothing reads nested objects
+        };
+
+        Type type = Null;
+        bool b = false;
+        std::string text; // a number as written in the file, or the string
+        std::vector<SceneValue> items; // Array
+
+        [[nodiscard]] bool isNumber() const { return type == Int || type == Float; }
+    };
+
+    // sorted by key, the order nlohmann::json iterates objects in
+    typedef std::map<std::string, SceneValue> SceneFields;
+
+    struct SceneAttribute {
+        std::string type; // empty if missing
+        std::string id;
+        std::string location;
+        bool hasData = false;
+        SceneFields data;
+    };
+
+    struct SceneObject {
+        std::string id;
+        bool hasId = false;
+        std::string prefab;
+        bool hasOverrides = false;
+        std::map<std::string, SceneFields> overrides; // attribute id -> fields
+        std::vector<SceneAttribute> attributes;
+        std::vector<SceneObject> children;
+    };
+
+    class SceneReader {
+    public:
+        int64_t engineVersion = -1;
+        int64_t dataId = -1;
+        bool hasData = false;
+        std::string name;
+        bool hasName = false;
+        bool is3d = false;
+        std::string error; // set when read fails
+
+        // called with each object in content, children included, as soon as it has been read, so only
+        // one top-level object is held at a time. The header fields above may come after content in
+        // the file, check them once read returns.
+        std::function<void(SceneObject &&object)> onObject;
+
+        // false on malformed JSON or a scene structure that can't be read
+        bool read(const std::string &path);
+    };
+
+}
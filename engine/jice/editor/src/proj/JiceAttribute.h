@@ -9,6 +9,7 @@
 #include "im_panel.h"
 #include "Engine/builtin/Transform.h"
 #include "Engine/builtin/Image2d.h"
+#include "Engine/util/SceneReader.h"
 
 using jice::AttributeData;
 using jice::AttributeInterface;
@@ -55,6 +56,73 @@ AttributeData toAttrData(nlohmann::json js) {
     return d;
 }
 
+// toAttrData for fields read by jice::SceneReader, numbers are kept as text until here
+AttributeData toAttrData(const jice::SceneFields& fields) {
+    AttributeData d = AttributeData();
+    for (auto& [key, value] : fields) {
+        if (value.type == jice::SceneValue::Int) {
+            d[key] = AttrData(std::stoi(value.text));
+        } else if (value.type == jice::SceneValue::Float) {
+            d[key] = AttrData(std::stof(value.text));
+        } else if (value.type == jice::SceneValue::String) {
+            d[key] = AttrData(value.text);
+        } else if (value.type == jice::SceneValue::Array) {
+            if (value.items.empty()) {
+                d[key] = AttrData();
+            } else if (value.items[0].type == jice::SceneValue::Int) {
+                std::vector<int> vec;
+                for (auto& v : value.items) {
+                    vec.push_back(v.isNumber() ? (int)std::stof(v.text) : 0);
+                }
+                d[key] = AttrData(vec);
+            } else if (value.items[0].type == jice::SceneValue::Float) {
+                std::vector<float> vec;
+                for (auto& v : value.items) {
+                    vec.push_back(v.isNumber() ? std::stof(v.text) : 0.0f);
+                }
+                d[key] = AttrData(vec);
+            } else {
+                std::cout << "Unsupported array type" << std::endl;
+            }
+        } else {
+            std::cout << "Unsupported type" << std::endl;
+        }
+    }
+    return d;
+}
+
+// back to JSON, for the parts of a scene the editor keeps as-is
+nlohmann::json sceneToJson(const jice::SceneValue& value) {
+    switch (value.type) {
+        case jice::SceneValue::Bool:
+            return value.b;
+        case jice::SceneValue::Int:
+        case jice::SceneValue::Float:
+            return nlohmann::json::parse(value.text);
+        case jice::SceneValue::String:
+            return value.text;
+        case jice::SceneValue::Array: {
+            nlohmann::json j = nlohmann::json::array();
+            for (auto& v : value.items) {
+                j.push_back(sceneToJson(v));
+            }
+            return j;
+        }
+        case jice::SceneValue::Object:
+            return nlohmann::json::object();
+        default:
+            return nullptr;
+    }
+}
+
+nlohmann::json sceneToJson(const jice::SceneFields& fields) {
+    nlohmann::json j = nlohmann::json::object();
+    for (auto& [key, value] : fields) {
+        j[key] = sceneToJson(value);
+    }
+    return j;
+}
+
 nlohmann::json attrToJson(AttributeData d) {
     nlohmann::json j = nlohmann::json::object();
     for (auto& [key, value] : d) {
@@ -127,6 +195,35 @@ struct JiceAttribute {
         }
     }
 
+    explicit JiceAttribute(const jice::SceneAttribute& attr) {
+        if (attr.type.empty()) {
+            throw std::runtime_error("Failed to find type");
+        }
+        if (attr.type == "builtin") {
+            m_builtin = true;
+            if (attr.id.empty()) {
+                throw std::runtime_error("Failed to find id");
+            }
+            m_id = attr.id;
+            if (m_id == Transform::COMPONENT_NAME) {
+                m_builtin_data = new Transform(toAttrData(attr.data));
+            } else if (m_id == Image2d::COMPONENT_NAME) {
+                m_builtin_data = new Image2d(toAttrData(attr.data), false);
+            } else {
+                throw std::runtime_error("Unknown builtin type");
+            }
+        } else if (attr.type == "script") {
+            m_builtin = false;
+            if (attr.location.empty()) {
+                throw std::runtime_error("Failed to find script");
+            }
+            m_script = attr.location;
+            m_data = toAttrData(attr.data);
+        } else {
+            throw std::runtime_error("Unknown type");
+        }
+    }
+
     static JiceAttribute Builtin(const std::string& id) {
         nlohmann::json j;
         j["type"] = "builtin";
@@ -155,7 +252,7 @@ struct JiceAttribute {
         if (m_builtin) {
             j["type"] = "builtin";
             j["id"] = m_id;
-            j["data"] = attrToJson(m_builtin_data->data);
+            j["data"] = attrToJson(m_builtin_data->data.flatten());
         } else {
             j["type"] = "script";
             j["location"] = m_script;
@@ -6,6 +6,9 @@
 
 struct JiceObject {
     std::string m_id;
+    // prefab instances are kept as-is, the editor does not resolve prefabs yet
+    std::string m_prefab;
+    nlohmann::json m_overrides;
     std::vector<JiceAttribute> m_attrs;
     std::vector<JiceObject*> m_children;
 
@@ -14,6 +17,12 @@ struct JiceObject {
             throw std::runtime_error("Failed to find id");
         }
         m_id = j["id"];
+        if (j.contains("prefab")) {
+            m_prefab = j["prefab"];
+            if (j.contains("overrides")) {
+                m_overrides = j["overrides"];
+            }
+        }
         if (j.contains("attributes")) {
             for (auto& attr : j["attributes"]) {
                 m_attrs.push_back(JiceAttribute(attr));
@@ -26,6 +35,31 @@ struct JiceObject {
         }
     }
 
+    // from jice::SceneReader, the way scenes are loaded
+    explicit JiceObject(const jice::SceneObject& obj) {
+        if (!obj.hasId) {
+            throw std::runtime_error("Failed to find id");
+        }
+        m_id = obj.id;
+        if (!obj.prefab.empty()) {
+            m_prefab = obj.prefab;
+            if (obj.hasOverrides) {
+                m_overrides = nlohmann::json::object();
+                for (auto& [attr_id, fields] : obj.overrides) {
+                    m_overrides[attr_id] = sceneToJson(fields);
+                }
+            }
+        }
+        m_attrs.reserve(obj.attributes.size());
+        for (auto& attr : obj.attributes) {
+            m_attrs.emplace_back(attr);
+        }
+        m_children.reserve(obj.children.size());
+        for (auto& child : obj.children) {
+            m_children.push_back(new JiceObject(child));
+        }
+    }
+
     explicit JiceObject(const std::string& id) : m_id(id) {}
 
     bool operator==(const JiceObject& rhs) const {
@@ -49,6 +83,12 @@ struct JiceObject {
     nlohmann::json toJson() {
         nlohmann::json j;
         j["id"] = m_id;
+        if (!m_prefab.empty()) {
+            j["prefab"] = m_prefab;
+            if (!m_overrides.is_null()) {
+                j["overrides"] = m_overrides;
+            }
+        }
         nlohmann::json attrs = nlohmann::json::array();
         for (auto& attr : m_attrs) {
             attrs.push_back(attr.toJson());
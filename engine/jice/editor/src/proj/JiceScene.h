@@ -17,41 +17,36 @@ struct JiceScene {
             std::cout << "Failed to find scene file" << std::endl;
             return;
         }
-        std::ifstream scene_file(path_to_scene_file);
-        if (!scene_file.is_open()) {
-            std::cout << "Failed to open scene file" << std::endl;
-            return;
-        }
-
         m_path = path_to_scene_file.string();
 
-        nlohmann::json j;
-        scene_file >> j;
-        scene_file.close();
-
-        if (!verify_json(j, 1, 100)) {
+        // objects are built as the file is read, without a JSON document of the whole scene in between
+        jice::SceneReader reader;
+        std::vector<JiceObject*> objects;
+        reader.onObject = [&](jice::SceneObject&& obj) {
+            objects.push_back(new JiceObject(obj));
+        };
+        bool ok = reader.read(m_path);
+        if (ok && (reader.engineVersion != 100 || reader.dataId != 1)) {
             std::cout << "Failed to verify json" << std::endl;
-            return;
-        }
-
-        if (!j.contains("data")) {
+            ok = false;
+        } else if (ok && !reader.hasData) {
             std::cout << "Failed to find data" << std::endl;
-            return;
+            ok = false;
+        } else if (ok && !reader.hasName) {
+            std::cout << "Failed to parse scene file: missing name" << std::endl;
+            ok = false;
+        } else if (!ok) {
+            std::cout << "Failed to parse scene file: " << reader.error << std::endl;
         }
-        nlohmann::json data = j["data"];
-        try {
-            m_name = data["name"];
-            m_3d = try_get(data, "3d", false);
-        } catch (nlohmann::json::exception& e) {
-            std::cout << "Failed to parse scene file: " << e.what() << std::endl;
-            return;
-        }
-        if (data.contains("content")) {
-            for (auto& obj : data["content"]) {
-                m_objects.push_back(new JiceObject(obj));
+        if (!ok) {
+            for (auto* obj : objects) {
+                delete obj;
             }
+            return;
         }
-
+        m_name = reader.name;
+        m_3d = reader.is3d;
+        m_objects = std::move(objects);
     }
 
     bool save() {
@@ -4,6 +4,32 @@
 #include <cstdint>
 #include <fstream>
 #include <algorithm>
+#include <map>
+#include <tuple>
+#include <set>
+#include <sstream>
+#include <iomanip>
+
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+#include <Engine/util/FileWatcher.h>
+#include <Engine/util/SceneReader.h>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
 
 using nlohmann::json;
 
@@ -13,6 +39,7 @@ enum class JsonID {
     Project=0,
     Scene=1,
     Meta=2,
+    Prefab=3,
 };
 
 enum class AssetType {
@@ -20,14 +47,58 @@ enum class AssetType {
     Copy=1,
 };
 
+enum class EmbedMode {
+    Incbin=0, // assembler stub that pulls the file in with .incbin (GCC/Clang)
+    Hex=1, // C++ array literal, works everywhere but is slow to compile
+};
+
+enum class SceneCodegen {
+    Code=0, // a constructor that builds every object with its own statements
+    Tables=1, // constant tables Scene::addObjects walks, much smaller and faster to compile for big scenes
+};
+
+enum class TextureFormat {
+    Source=0, // the file as-is, decoded at runtime
+    RGBA8=1,
+    RGBA8Premultiplied=2,
+};
+
+// opt-in per asset with "texture" in its .jmeta, decoded images are far bigger than the PNGs they come from
+struct TextureImport {
+    TextureFormat format = TextureFormat::Source;
+    bool mipmaps = true;
+};
+
+enum class Compression {
+    None=0,
+    LZ4=1, // must match jice::CompressionCodec
+    Zstd=2,
+};
+
+struct CompressionOptions {
+    Compression codec = Compression::None;
+    int level = 0; // 0 = the codec's default
+};
+
+// a shader stage file after preprocessing, variants are written next to it
+struct ShaderStage {
+    AssetType type;
+    fs::path rel_file;
+    std::string base; // preprocessed source without any variant defines
+    std::map<std::string, std::string> variants; // name -> preprocessed file
+};
+
 struct Asset {
     AssetType type;
     std::string name;
     std::string dst;
     std::string src; // only this is used in Copy mode
+    std::string file; // what actually ships, the source file or what the import step made from it
+    std::string shares; // src of an earlier asset with identical bytes, which this one points at instead
 
     bool operator==(const Asset& other) const {
-        return type == other.type && name == other.name && dst == other.dst && src == other.src;
+        return type == other.type && name == other.name && dst == other.dst && src == other.src && file == other.file &&
+               shares == other.shares;
     }
 };
 
@@ -86,6 +157,20 @@ std::string hex_num(uint8_t num) {
     return ss.str();
 }
 
+// appends the bytes as "0x.., " text, 16 per line
+void append_hex(std::string& out, const char* data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    out.reserve(out.size() + size * 6 + size / 16 + 1);
+    for (size_t i = 0; i < size; i++) {
+        auto byte = (uint8_t)data[i];
+        char text[6] = {'0', 'x', digits[byte >> 4], digits[byte & 0xf], ',', ' '};
+        out.append(text, 6);
+        if (i % 16 == 15) {
+            out += '\n';
+        }
+    }
+}
+
 std::string name_path(const fs::path& path) {
     // name version of a path that is a valid C++ identifier
     std::string out = "_";
@@ -105,6 +190,695 @@ std::string name_path(const std::string& path) {
     return name_path(fs::path(path));
 }
 
+uint64_t fnv1a64(const std::string& str) {
+    // must match jice::fnv1a64 in Engine/internal/AssetPack.cpp
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c: str) {
+        hash ^= (uint8_t) c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t fnv1a64(const std::vector<char>& data) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c: data) {
+        hash ^= (uint8_t) c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// bytes read and written, per thread so a job can tell what it did itself, and in total, for --timings
+struct IoCount {
+    uint64_t read = 0;
+    uint64_t written = 0;
+};
+
+thread_local IoCount thread_io;
+std::atomic<uint64_t> total_read{0};
+std::atomic<uint64_t> total_written{0};
+
+void count_read(uint64_t bytes) {
+    thread_io.read += bytes;
+    total_read += bytes;
+}
+
+void count_written(uint64_t bytes) {
+    thread_io.written += bytes;
+    total_written += bytes;
+}
+
+std::vector<char> read_file(const std::string& path) {
+    std::error_code ec;
+    count_read(fs::file_size(path, ec));
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+template<typename T>
+void write_raw(std::ostream& out, T value) {
+    // .jpak is little endian, like every platform we build for
+    out.write((const char*)&value, sizeof(T));
+}
+
+void write_padding(std::ostream& out, uint64_t& pos, uint64_t align) {
+    while (pos % align != 0) {
+        out.put(0);
+        pos++;
+    }
+}
+
+// Workers print into a buffer of their own that parallel_for prints in job order once they're all
+// done, so the log reads the same no matter how the jobs were scheduled
+struct JobLog {
+    std::ostringstream out;
+    std::ostringstream err;
+};
+
+thread_local JobLog* job_log = nullptr;
+// errors log_err reported on this thread, for callers that need to know whether a step failed
+thread_local size_t error_count = 0;
+
+std::ostream& log_out() {
+    return job_log != nullptr ? job_log->out : std::cout;
+}
+
+std::ostream& log_err() {
+    error_count++;
+    return job_log != nullptr ? job_log->err : std::cerr;
+}
+
+unsigned int job_threads = 0; // -j, 0 = one per core
+std::string depfile; // --depfile, where to list the files a run read
+
+// runs fn(0) .. fn(count - 1) spread over job_threads threads
+void parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+    std::vector<JobLog> logs(count);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            job_log = &logs[i];
+            fn(i);
+            job_log = nullptr;
+        }
+    };
+    unsigned int threads = job_threads != 0 ? job_threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned int)std::min<size_t>(threads, count);
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread: pool) {
+        thread.join();
+    }
+    for (auto& log: logs) {
+        std::cout << log.out.str();
+        std::cerr << log.err.str();
+    }
+}
+
+// What the last run generated and what each expensive output was made from, kept in
+// build/jicc_manifest.json. Outputs are only rewritten when their bytes change, so CMake only
+// rebuilds what an edit actually touched, and outputs a run no longer makes are deleted. Paths are kept
+// relative to the build folder, so runs from different working directories agree on them.
+struct Manifest {
+    fs::path root; // the build folder, absolute
+    std::set<std::string> outputs;
+    std::map<std::string, std::string> inputs; // output -> hash of its inputs
+    std::set<std::string> old_outputs;
+    std::map<std::string, std::string> old_inputs;
+    size_t written = 0;
+    size_t unchanged = 0;
+    size_t reused = 0; // outputs whose inputs didn't change, so the work was skipped
+    std::mutex mutex; // outputs are written from parallel_for jobs
+    bool loaded = false;
+    // --watch: content hash of every output as last written, so unchanged outputs are recognized without
+    // reading them back
+    bool remember = false;
+    std::unordered_map<std::string, uint64_t> known;
+    bool failed = false; // an output couldn't be written
+
+    void load(const fs::path& path) {
+        loaded = true;
+        root = fs::absolute(path.parent_path()).lexically_normal();
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            return;
+        }
+        json j = json::parse(in, nullptr, false);
+        if (j.is_discarded() || j.value("engine_version", 0) != JICE_ENGINE_VERSION ||
+            j.value("relative_to", "") != "build") {
+            return; // made by another version, its outputs get compared and rewritten anyway
+        }
+        old_outputs = j["outputs"].get<std::set<std::string>>();
+        old_inputs = j["inputs"].get<std::map<std::string, std::string>>();
+    }
+
+    void save(const fs::path& path) {
+        json j = {
+                {"engine_version", JICE_ENGINE_VERSION},
+                {"relative_to", "build"},
+                {"outputs", outputs},
+                {"inputs", inputs}
+        };
+        std::ofstream out(path);
+        out << j.dump(1);
+    }
+
+    // this run's outputs become the ones the next run compares against. A run that stopped early only
+    // saw some of them, so nothing the runs before it made is forgotten.
+    void next_run(bool complete) {
+        if (complete) {
+            old_outputs = std::move(outputs);
+            old_inputs = std::move(inputs);
+        } else {
+            old_outputs.insert(outputs.begin(), outputs.end());
+            for (auto& [output, input]: inputs) {
+                old_inputs[output] = input;
+            }
+        }
+        outputs.clear();
+        inputs.clear();
+        written = unchanged = reused = 0;
+        failed = false;
+    }
+
+    // dst relative to root, how outputs are keyed
+    std::string key(const fs::path& dst) const {
+        return cify_path(fs::absolute(dst).lexically_normal().lexically_relative(root));
+    }
+
+    // a key back to its file, empty for one that isn't under root, those are never deleted
+    fs::path resolve(const std::string& key) const {
+        fs::path rel(key);
+        if (key.empty() || rel.is_absolute() || rel.has_root_name() || *rel.begin() == "..") {
+            return {};
+        }
+        return root / rel;
+    }
+
+    // true if dst had to be (re)written
+    bool write(const fs::path& dst, const std::string& data) {
+        std::string path = key(dst);
+        uint64_t hash = remember ? fnv1a64(data) : 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            outputs.insert(path);
+            auto it = known.find(path);
+            if (it != known.end() && it->second == hash && fs::exists(dst)) {
+                unchanged++;
+                return false;
+            }
+        }
+        std::error_code ec;
+        bool same = false;
+        if (fs::exists(dst) && fs::file_size(dst, ec) == data.size()) {
+            std::vector<char> existing = read_file(cify_path(dst));
+            same = std::equal(existing.begin(), existing.end(), data.begin());
+        }
+        if (!same && !replace(dst, data)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = true;
+            return false;
+        }
+        if (!same) {
+            count_written(data.size());
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (remember) {
+            known[path] = hash;
+        }
+        (same ? unchanged : written)++;
+        return !same;
+    }
+
+    // Written next to dst and renamed over it, so a running game that mapped the old file keeps its
+    // pages instead of seeing them truncated
+    static bool replace(const fs::path& dst, const std::string& data) {
+        std::error_code ec;
+        fs::create_directories(dst.parent_path(), ec);
+        fs::path tmp = dst;
+        tmp += ".jicc-tmp";
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(data.data(), (std::streamsize)data.size());
+        out.close();
+        if (out.fail()) {
+            log_err() << "Error: Failed to write '" << cify_path(dst) << "'" << std::endl;
+            fs::remove(tmp, ec);
+            return false;
+        }
+        fs::rename(tmp, dst, ec);
+        if (ec) {
+            log_err() << "Error: Failed to replace '" << cify_path(dst) << "': " << ec.message() << std::endl;
+            fs::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    bool copy(const fs::path& src, const fs::path& dst) {
+        std::vector<char> data = read_file(cify_path(src));
+        return write(dst, std::string(data.begin(), data.end()));
+    }
+
+    // dst still exists and was made from the same inputs last run, it's kept without redoing the work
+    bool fresh(const fs::path& dst, const std::string& input) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = old_inputs.find(key(dst));
+        if (it == old_inputs.end() || it->second != input || !fs::exists(dst)) {
+            return false;
+        }
+        outputs.insert(key(dst));
+        inputs[key(dst)] = input;
+        reused++;
+        return true;
+    }
+
+    void made_from(const fs::path& dst, const std::string& input) {
+        std::lock_guard<std::mutex> lock(mutex);
+        outputs.insert(key(dst));
+        inputs[key(dst)] = input;
+    }
+
+    // for a run that failed, what the last run made stays on disk and in the manifest, so nothing the
+    // game's build still refers to is deleted before the error is fixed
+    void keep_stale() {
+        outputs.insert(old_outputs.begin(), old_outputs.end());
+        for (auto& [output, input]: old_inputs) {
+            inputs.emplace(output, input);
+        }
+    }
+
+    // deletes what the last run made and this one didn't, returns how many
+    size_t remove_stale() {
+        size_t removed = 0;
+        for (auto& path: old_outputs) {
+            if (outputs.count(path) != 0) {
+                continue;
+            }
+            fs::path file = resolve(path);
+            std::error_code ec;
+            if (file.empty()) {
+                std::cout << "Warning: not removing '" << path << "', it is outside the build folder" << std::endl;
+            } else if (fs::remove(file, ec)) {
+                known.erase(path);
+                removed++;
+            }
+        }
+        return removed;
+    }
+};
+
+// identifies what an output is made from, the file's content plus whatever options shape the output
+std::string input_hash(const std::string& file, const std::string& options) {
+    return std::to_string(fnv1a64(read_file(file))) + ":" + options;
+}
+
+// A generated file that only reaches the disk through Manifest::write when it's closed
+class OutputFile : public std::ostringstream {
+public:
+    OutputFile(Manifest& manifest, const fs::path& path) : manifest(manifest), path(path) {}
+
+    ~OutputFile() override {
+        close();
+    }
+
+    void open(const fs::path& next) {
+        close();
+        path = next;
+        str("");
+    }
+
+    void close() {
+        if (!path.empty()) {
+            manifest.write(path, str());
+            path.clear();
+        }
+    }
+
+private:
+    Manifest& manifest;
+    fs::path path;
+};
+
+// --watch keeps what importing each asset produced, so a regeneration only redoes the files that changed
+struct ImportCache {
+    struct Entry {
+        fs::file_time_type mtime;
+        uintmax_t size = 0;
+        std::string options; // import, compression and mode settings from the .jmeta
+        std::string file;
+        uint64_t hash = 0;
+        std::vector<std::pair<fs::path, std::string>> made; // intermediate outputs and their input hashes
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+// --timings: wall time and I/O of each phase of a run and of each asset
+struct Timings {
+    struct Row {
+        std::string name;
+        double ms = 0;
+        uint64_t read = 0;
+        uint64_t written = 0;
+    };
+
+    bool enabled = false;
+    bool running = false;
+    std::vector<Row> phases;
+    std::vector<Row> assets;
+    std::chrono::high_resolution_clock::time_point start;
+    uint64_t start_read = 0;
+    uint64_t start_written = 0;
+
+    // ends the previous phase (if any) and starts timing the next one
+    void phase(const std::string& name) {
+        end_phase();
+        phases.push_back({name});
+        running = true;
+        start = std::chrono::high_resolution_clock::now();
+        start_read = total_read;
+        start_written = total_written;
+    }
+
+    void end_phase() {
+        if (!running) {
+            return;
+        }
+        running = false;
+        Row& row = phases.back();
+        row.ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        row.read = total_read - start_read;
+        row.written = total_written - start_written;
+    }
+
+    static void print_row(const Row& row) {
+        std::cout << "  " << std::left << std::setw(40) << row.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << row.ms << std::setw(14) << row.read << std::setw(14) << row.written << std::endl;
+    }
+
+    void print() {
+        end_phase();
+        if (!enabled) {
+            return;
+        }
+        Row total = {"total"};
+        std::cout << "TIMINGS: " << std::left << std::setw(40) << "phase" << std::right << std::setw(10) << "ms"
+                  << std::setw(14) << "bytes read" << std::setw(14) << "bytes written" << std::endl;
+        for (auto& row: phases) {
+            print_row(row);
+            total.ms += row.ms;
+            total.read += row.read;
+            total.written += row.written;
+        }
+        print_row(total);
+        // slowest first, that's what anyone reading this is looking for
+        std::sort(assets.begin(), assets.end(), [](const Row& a, const Row& b) { return a.ms > b.ms; });
+        std::cout << "TIMINGS: " << std::left << std::setw(40) << "asset" << std::right << std::setw(10) << "ms"
+                  << std::setw(14) << "bytes read" << std::setw(14) << "bytes written" << std::endl;
+        for (auto& row: assets) {
+            print_row(row);
+        }
+        std::cout.unsetf(std::ios::floatfield);
+    }
+};
+
+Timings timings;
+
+bool is_image(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga";
+}
+
+TextureImport parse_texture_import(const json& meta) {
+    TextureImport import;
+    if (!meta.contains("texture")) {
+        return import;
+    }
+    const json& tex = meta["texture"];
+    if (tex.is_boolean()) {
+        import.format = tex ? TextureFormat::RGBA8 : TextureFormat::Source;
+        return import;
+    }
+    import.format = TextureFormat::RGBA8;
+    if (tex.contains("format")) {
+        std::string format = tex["format"];
+        if (format == "rgba8") {
+            import.format = TextureFormat::RGBA8;
+        } else if (format == "rgba8_premultiplied") {
+            import.format = TextureFormat::RGBA8Premultiplied;
+        } else if (format == "source") {
+            import.format = TextureFormat::Source;
+        } else {
+            // block compressed formats would need an encoder here and a matching upload path in Texture
+            log_out() << "Warning: texture format '" << format << "' is not supported, using rgba8" << std::endl;
+        }
+    }
+    if (tex.contains("mipmaps")) {
+        import.mipmaps = tex["mipmaps"];
+    }
+    return import;
+}
+
+// 2x2 box filter, odd edges are clamped. Straight alpha is weighted by alpha so transparent texels
+// don't darken the edges of what's left.
+std::vector<uint8_t> downsample(const std::vector<uint8_t>& src, int w, int h, bool premultiplied) {
+    int dw = std::max(w / 2, 1);
+    int dh = std::max(h / 2, 1);
+    std::vector<uint8_t> dst((size_t)dw * dh * 4);
+    for (int y = 0; y < dh; y++) {
+        for (int x = 0; x < dw; x++) {
+            const uint8_t* texels[4];
+            int xs[2] = {std::min(x * 2, w - 1), std::min(x * 2 + 1, w - 1)};
+            int ys[2] = {std::min(y * 2, h - 1), std::min(y * 2 + 1, h - 1)};
+            for (int i = 0; i < 4; i++) {
+                texels[i] = &src[((size_t)ys[i / 2] * w + xs[i % 2]) * 4];
+            }
+            uint32_t alpha = 0;
+            for (auto t: texels) {
+                alpha += t[3];
+            }
+            uint8_t* out = &dst[((size_t)y * dw + x) * 4];
+            for (int c = 0; c < 3; c++) {
+                uint32_t sum = 0;
+                if (premultiplied || alpha == 0) {
+                    for (auto t: texels) {
+                        sum += t[c];
+                    }
+                    out[c] = (uint8_t)((sum + 2) / 4);
+                } else {
+                    for (auto t: texels) {
+                        sum += t[c] * t[3];
+                    }
+                    out[c] = (uint8_t)((sum + alpha / 2) / alpha);
+                }
+            }
+            out[3] = (uint8_t)((alpha + 2) / 4);
+        }
+    }
+    return dst;
+}
+
+// Decodes src and writes it as a .jtex (layout in Engine/util/Image.h), false if src isn't an image. Runs
+// on parallel_for workers, stb's flip flag is set once before they start.
+bool import_texture(Manifest& manifest, const std::string& src, const fs::path& dst, const TextureImport& import) {
+    int width, height, channels;
+    count_read(fs::file_size(src));
+    stbi_uc* decoded = stbi_load(src.c_str(), &width, &height, &channels, 4);
+    if (decoded == nullptr) {
+        log_out() << "Warning: could not decode '" << src << "' (" << stbi_failure_reason() << "), embedding as-is" << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> pixels(decoded, decoded + (size_t)width * height * 4);
+    stbi_image_free(decoded);
+
+    bool premultiplied = import.format == TextureFormat::RGBA8Premultiplied;
+    if (premultiplied) {
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            for (int c = 0; c < 3; c++) {
+                pixels[i + c] = (uint8_t)((pixels[i + c] * pixels[i + 3] + 127) / 255);
+            }
+        }
+    }
+
+    OutputFile out(manifest, dst);
+    uint32_t levels = 1;
+    if (import.mipmaps) {
+        while ((width >> levels) > 0 || (height >> levels) > 0) {
+            levels++;
+        }
+    }
+    write_raw<uint32_t>(out, 0x5845544a); // "JTEX"
+    write_raw<uint16_t>(out, 1); // version
+    write_raw<uint16_t>(out, 0); // RGBA8
+    write_raw<uint32_t>(out, width);
+    write_raw<uint32_t>(out, height);
+    write_raw<uint32_t>(out, levels);
+    write_raw<uint32_t>(out, premultiplied ? 1 : 0);
+    write_raw<uint64_t>(out, 0);
+    int w = width, h = height;
+    for (uint32_t level = 0; level < levels; level++) {
+        if (level > 0) {
+            pixels = downsample(pixels, w, h, premultiplied);
+            w = std::max(w / 2, 1);
+            h = std::max(h / 2, 1);
+        }
+        out.write((const char*)pixels.data(), (std::streamsize)pixels.size());
+    }
+    out.close();
+    log_out() << "TEXTURE: '" << src << "' " << width << "x" << height << ", " << levels << " levels, "
+              << fs::file_size(src) << " -> " << fs::file_size(dst) << " bytes" << std::endl;
+    return true;
+}
+
+CompressionOptions parse_compression(const json& meta) {
+    CompressionOptions options;
+    if (!meta.contains("compression")) {
+        return options;
+    }
+    // either "lz4" or {"codec": "lz4", "level": 12}
+    const json& comp = meta["compression"];
+    std::string codec = comp.is_string() ? comp.get<std::string>() : comp.value("codec", "none");
+    if (comp.is_object() && comp.contains("level")) {
+        options.level = comp["level"];
+    }
+    if (codec == "lz4") {
+        options.codec = Compression::LZ4;
+    } else if (codec == "zstd") {
+        options.codec = Compression::Zstd;
+    } else if (codec != "none") {
+        log_out() << "Warning: unknown compression '" << codec << "', storing uncompressed" << std::endl;
+    }
+    return options;
+}
+
+// writes src as a .jcmp (layout in Engine/util/Compression.h) and reports how it did, so the codec can be
+// picked per asset. false if compressing doesn't make it smaller, then the asset is stored as-is
+bool compress_asset(Manifest& manifest, const std::string& src, const fs::path& dst, const CompressionOptions& options) {
+    const uint32_t chunk_size = 256 * 1024;
+    std::vector<char> raw = read_file(src);
+
+    auto chunk_count = (uint32_t)((raw.size() + chunk_size - 1) / chunk_size);
+    std::vector<std::vector<char>> chunks(chunk_count);
+    for (uint32_t i = 0; i < chunk_count; i++) {
+        const char* chunk = raw.data() + (size_t)i * chunk_size;
+        size_t size = std::min<size_t>(chunk_size, raw.size() - (size_t)i * chunk_size);
+        std::vector<char>& out = chunks[i];
+        if (options.codec == Compression::LZ4) {
+            out.resize(LZ4_compressBound((int)size));
+            int level = options.level != 0 ? options.level : LZ4HC_CLEVEL_DEFAULT;
+            out.resize(LZ4_compress_HC(chunk, out.data(), (int)size, (int)out.size(), level));
+        } else {
+            out.resize(ZSTD_compressBound(size));
+            int level = options.level != 0 ? options.level : 19;
+            size_t written = ZSTD_compress(out.data(), out.size(), chunk, size, level);
+            if (ZSTD_isError(written)) {
+                log_err() << "Error: zstd failed on '" << src << "': " << ZSTD_getErrorName(written) << std::endl;
+                return false;
+            }
+            out.resize(written);
+        }
+    }
+
+    uint64_t packed = 24 + (uint64_t)chunk_count * 4;
+    for (auto& chunk: chunks) {
+        packed += chunk.size();
+    }
+    const char* codec_name = options.codec == Compression::LZ4 ? "lz4" : "zstd";
+    if (packed >= raw.size()) {
+        log_out() << "COMPRESS: '" << src << "' does not shrink with " << codec_name << ", stored raw" << std::endl;
+        return false;
+    }
+
+    // time a decode the same way the engine does it, chunk by chunk into one buffer
+    std::vector<char> check(raw.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    for (uint32_t i = 0; i < chunk_count; i++) {
+        size_t size = std::min<size_t>(chunk_size, raw.size() - (size_t)i * chunk_size);
+        char* dst_chunk = check.data() + (size_t)i * chunk_size;
+        if (options.codec == Compression::LZ4) {
+            LZ4_decompress_safe(chunks[i].data(), dst_chunk, (int)chunks[i].size(), (int)size);
+        } else {
+            ZSTD_decompressDCtx(dctx, dst_chunk, size, chunks[i].data(), chunks[i].size());
+        }
+    }
+    ZSTD_freeDCtx(dctx);
+    double decode_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    if (check != raw) {
+        log_err() << "Error: " << codec_name << " round trip failed for '" << src << "'" << std::endl;
+        return false;
+    }
+
+    OutputFile out(manifest, dst);
+    write_raw<uint32_t>(out, 0x504d434a); // "JCMP"
+    write_raw<uint16_t>(out, 1); // version
+    write_raw<uint16_t>(out, (uint16_t)options.codec);
+    write_raw<uint32_t>(out, chunk_size);
+    write_raw<uint32_t>(out, chunk_count);
+    write_raw<uint64_t>(out, raw.size());
+    for (auto& chunk: chunks) {
+        write_raw<uint32_t>(out, (uint32_t)chunk.size());
+    }
+    for (auto& chunk: chunks) {
+        out.write(chunk.data(), (std::streamsize)chunk.size());
+    }
+    out.close();
+    log_out() << "COMPRESS: '" << src << "' " << codec_name << " " << raw.size() << " -> " << packed << " bytes ("
+              << std::fixed << std::setprecision(1) << 100.0 * packed / raw.size() << "%), decodes in "
+              << std::setprecision(3) << decode_ms << "ms" << std::defaultfloat << std::endl;
+    return true;
+}
+
+bool is_shader(const fs::path& path) {
+    std::string ext = path.extension().string();
+    return ext == ".vert" || ext == ".vs" || ext == ".frag" || ext == ".fs";
+}
+
+bool is_vertex_shader(const fs::path& path) {
+    std::string ext = path.extension().string();
+    return ext == ".vert" || ext == ".vs";
+}
+
+// "shader": {"variants": {"fog": ["USE_FOG", "FOG_DENSITY=0.2"]}} -> variant name -> defines
+std::map<std::string, std::vector<std::string>> parse_shader_variants(const json& meta) {
+    std::map<std::string, std::vector<std::string>> variants;
+    if (!meta.contains("shader") || !meta["shader"].contains("variants")) {
+        return variants;
+    }
+    for (auto& [name, defines]: meta["shader"]["variants"].items()) {
+        variants[name] = defines.get<std::vector<std::string>>();
+    }
+    return variants;
+}
+
+// #defines go right after #version, which GLSL requires to come first
+std::string add_defines(const std::string& source, const std::vector<std::string>& defines) {
+    std::string block;
+    for (auto& define: defines) {
+        size_t eq = define.find('=');
+        if (eq == std::string::npos) {
+            block += "#define " + define + "\n";
+        } else {
+            block += "#define " + define.substr(0, eq) + " " + define.substr(eq + 1) + "\n";
+        }
+    }
+    size_t version = source.find("#version");
+    if (version == std::string::npos) {
+        return block + source;
+    }
+    size_t line_end = source.find('\n', version);
+    if (line_end == std::string::npos) {
+        return source + "\n" + block;
+    }
+    return source.substr(0, line_end + 1) + block + source.substr(line_end + 1);
+}
+
 std::string dispatch_string(const std::string& source) {
     // create a string that uses a hash of source
     std::hash<std::string> hasher;
@@ -116,102 +890,345 @@ std::string dispatch_string(const std::string& source) {
 
 json verify_json(json j, JsonID id) {
     if (j.find("engine_version") == j.end()) {
-        std::cerr << "Error: JSON missing engine_version" << std::endl;
+        log_err() << "Error: JSON missing engine_version" << std::endl;
         return {};
     }
     if (j["engine_version"] != JICE_ENGINE_VERSION) {
-        std::cerr << "Error: JSON engine_version mismatch" << std::endl;
+        log_err() << "Error: JSON engine_version mismatch" << std::endl;
         return {};
     }
     if (j.find("data_id") == j.end()) {
-        std::cerr << "Error: JSON missing data_id" << std::endl;
+        log_err() << "Error: JSON missing data_id" << std::endl;
         return {};
     }
     if (j["data_id"] != (int)id) {
-        std::cerr << "Error: JSON data_id mismatch" << std::endl;
+        log_err() << "Error: JSON data_id mismatch" << std::endl;
         return {};
     }
     if (j.find("data") == j.end()) {
-        std::cerr << "Error: JSON missing data" << std::endl;
+        log_err() << "Error: JSON missing data" << std::endl;
         return {};
     }
     return j["data"];
 }
 
-bool all_is_int(json j) {
-    for (auto& v: j) {
-        if (!v.is_number_integer()) {
-            return false;
-        }
-    }
-    return true;
+bool all_are(const std::vector<jice::SceneValue>& items, bool (*test)(const jice::SceneValue&)) {
+    return std::all_of(items.begin(), items.end(), test);
 }
 
-bool all_is_number(json j) {
-    for (auto& v: j) {
-        if (!v.is_number()) {
-            return false;
-        }
-    }
-    return true;
+bool is_int(const jice::SceneValue& v) {
+    return v.type == jice::SceneValue::Int;
 }
 
-std::string join(json j, std::string sep) {
-    std::ostringstream ss;
-    for (auto& v: j) {
-        ss << v << sep;
+bool is_number(const jice::SceneValue& v) {
+    return v.isNumber();
+}
+
+std::string join(const std::vector<jice::SceneValue>& items, const std::string& sep) {
+    std::string out;
+    for (auto& v: items) {
+        out += (out.empty() ? "" : sep) + v.text;
     }
-    std::string out = ss.str();
-    return out.substr(0, out.size() - sep.size());
+    return out;
 }
 
-std::string parse_attr_data(json j, std::string dat_id) {
+// parse_attr_data for fields read by jice::SceneReader, numbers are emitted as written in the scene
+std::string parse_attr_data(const jice::SceneFields& fields, const std::string& dat_id) {
     std::ostringstream ss;
-    // for pairs in data
-    for (auto& [k_i, v]: j.items()) {
+    for (auto& [k_i, v]: fields) {
         std::string k = '"' + k_i + '"';
-        if (v.is_array()) {
-            if (all_is_int(v)) {
-                ss << dat_id << '[' << k << "] = AttrData(std::vector<int>{" << join(v, ", ") << "});\n";
-            } else if (all_is_number(v)) {
-                ss << dat_id << '[' << k << "] = AttrData(std::vector<float>{" << join(v, ", ") << "});\n";
+        if (v.type == jice::SceneValue::Array) {
+            if (all_are(v.items, is_int)) {
+                ss << dat_id << '[' << k << "] = AttrData(std::vector<int>{" << join(v.items, ", ") << "});\n";
+            } else if (all_are(v.items, is_number)) {
+                ss << dat_id << '[' << k << "] = AttrData(std::vector<float>{" << join(v.items, ", ") << "});\n";
             } else {
-                std::cout << "Error: unsupported array type, assuming string!!!" << std::endl;
-                ss << dat_id << '[' << k << "] = AttrData(std::vector<std::string>{" << join(v, ", ") << "});\n";
+                log_err() << "Error: unsupported array type" << std::endl;
             }
-        } else if (v.is_number()) {
-            ss << dat_id << '[' << k << "] = AttrData(" << v << ");\n";
-        } else if (v.is_string()) {
-            ss << dat_id << '[' << k << "] = AttrData(\"" << std::string(v) << "\");\n";
+        } else if (v.isNumber()) {
+            ss << dat_id << '[' << k << "] = AttrData(" << v.text << ");\n";
+        } else if (v.type == jice::SceneValue::String) {
+            ss << dat_id << '[' << k << "] = AttrData(\"" << v.text << "\");\n";
         } else {
-            std::cerr << "Error: unsupported data type" << std::endl;
+            log_err() << "Error: unsupported data type" << std::endl;
         }
     }
     return ss.str();
 }
 
+// builtin id -> the program it draws with, must match the default shader arguments in Engine/builtin
+const std::map<std::string, std::string> BUILTIN_SHADERS = {
+        {"image2d", "default_3f2f_pt"},
+        {"square", "default_3f_p"},
+};
+
+// every string value anywhere in j, scenes and prefabs name their assets this way
+void collect_strings(const json& j, std::set<std::string>& out) {
+    if (j.is_string()) {
+        out.insert(j.get<std::string>());
+    } else if (j.is_structured()) {
+        for (auto& v: j) {
+            collect_strings(v, out);
+        }
+    }
+}
+
+// collect_strings for a whole JSON file, read as it is parsed so large scenes are never held in memory
+struct StringCollector : nlohmann::json_sax<json> {
+    std::set<std::string>& out;
+
+    explicit StringCollector(std::set<std::string>& out) : out(out) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool string(string_t& val) override { out.insert(std::move(val)); return true; }
+    bool binary(binary_t&) override { return true; }
+    bool start_object(std::size_t) override { return true; }
+    bool key(string_t&) override { return true; }
+    bool end_object() override { return true; }
+    bool start_array(std::size_t) override { return true; }
+    bool end_array() override { return true; }
+    // like json::parse without exceptions, what was read before the error is kept
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override { return false; }
+};
+
+void collect_strings(const fs::path& file, std::set<std::string>& out) {
+    std::ifstream in(file, std::ios::binary);
+    StringCollector collector(out);
+    json::sax_parse(in, &collector);
+}
+
+// the contents of every "..." literal in a C++ source, escapes are left as written
+void collect_string_literals(const std::string& source, std::set<std::string>& out) {
+    for (size_t i = 0; i < source.size(); i++) {
+        if (source[i] != '"' || (i > 0 && source[i - 1] == '\\')) {
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < source.size() && source[end] != '"' && source[end] != '\n') {
+            end += source[end] == '\\' ? 2 : 1;
+        }
+        if (end < source.size() && source[end] == '"') {
+            out.insert(source.substr(i + 1, end - i - 1));
+        }
+        i = end;
+    }
+}
+
+// a prefab's attribute data as the fields jice::SceneReader would have read, so prefabs and scenes go
+// through the same parse_attr_data. Floats are written the way nlohmann prints them.
+jice::SceneValue scene_value(const json& v) {
+    jice::SceneValue value;
+    if (v.is_boolean()) {
+        value.type = jice::SceneValue::Bool;
+        value.b = v.get<bool>();
+    } else if (v.is_number_integer()) {
+        value.type = jice::SceneValue::Int;
+        value.text = v.dump();
+    } else if (v.is_number()) {
+        value.type = jice::SceneValue::Float;
+        value.text = v.dump();
+    } else if (v.is_string()) {
+        value.type = jice::SceneValue::String;
+        value.text = v.get<std::string>();
+    } else if (v.is_array()) {
+        value.type = jice::SceneValue::Array;
+        for (auto& item: v) {
+            value.items.push_back(scene_value(item));
+        }
+    } else if (v.is_object()) {
+        value.type = jice::SceneValue::Object;
+    }
+    return value;
+}
+
+jice::SceneFields scene_fields(const json& j) {
+    jice::SceneFields fields;
+    for (auto& [k, v]: j.items()) {
+        fields[k] = scene_value(v);
+    }
+    return fields;
+}
+
+// a scene's objects as the constant tables Scene::addObjects reads, in the order the code mode would
+// create them
+struct SceneTableWriter {
+    std::ostringstream objects;
+    std::ostringstream attributes;
+    std::ostringstream fields;
+    std::ostringstream floats;
+    std::ostringstream ints;
+    std::ostringstream strings;
+    uint32_t object_count = 0;
+    uint32_t attribute_count = 0;
+    uint32_t field_count = 0;
+    uint32_t float_count = 0;
+    uint32_t int_count = 0;
+    uint32_t string_count = 0;
+
+    // same conversions as parse_attr_data
+    void add_field(const std::string& key, const jice::SceneValue& v) {
+        std::string type;
+        uint32_t index = 0;
+        uint32_t count = 0;
+        if (v.type == jice::SceneValue::Array) {
+            if (all_are(v.items, is_int)) {
+                type = "VecI";
+                index = int_count;
+                for (auto& e: v.items) {
+                    ints << e.text << ", ";
+                }
+                int_count += (uint32_t)v.items.size();
+            } else if (all_are(v.items, is_number)) {
+                type = "VecF";
+                index = float_count;
+                for (auto& e: v.items) {
+                    floats << e.text << ", ";
+                }
+                float_count += (uint32_t)v.items.size();
+            } else {
+                log_err() << "Error: unsupported array type" << std::endl;
+                return;
+            }
+            count = (uint32_t)v.items.size();
+        } else if (v.type == jice::SceneValue::Int) {
+            type = "Int";
+            index = int_count++;
+            ints << v.text << ", ";
+        } else if (v.type == jice::SceneValue::Float) {
+            type = "Float";
+            index = float_count++;
+            floats << v.text << ", ";
+        } else if (v.type == jice::SceneValue::String) {
+            type = "String";
+            index = string_count++;
+            strings << json(v.text).dump() << ", ";
+        } else {
+            log_err() << "Error: unsupported data type" << std::endl;
+            return;
+        }
+        fields << "{" << json(key).dump() << ", " << type << ", " << index << ", " << count << "},\n";
+        field_count++;
+    }
+
+    void add_attribute(const std::string& kind, const std::string& id, int32_t script,
+                       const jice::SceneFields& data = {}) {
+        uint32_t first = field_count;
+        for (auto& [key, value]: data) {
+            add_field(key, value);
+        }
+        attributes << "{SceneAttributeKind::" << kind << ", " << json(id).dump() << ", " << script << ", " << first << ", "
+                   << field_count - first << "},\n";
+        attribute_count++;
+    }
+
+    // attributes are added between this and end_object
+    uint32_t begin_object(const std::string& name, const std::string& prefab, int32_t parent) {
+        objects << "{\"" << name << "\", " << (prefab.empty() ? "nullptr" : json(prefab).dump()) << ", " << parent
+                << ", " << attribute_count << ", ";
+        return attribute_count;
+    }
+
+    void end_object(uint32_t first_attribute) {
+        objects << attribute_count - first_attribute << "},\n";
+        object_count++;
+    }
+
+    // values is emptied once written, big scenes would otherwise hold every table twice
+    static void write_array(std::ostream& out, const std::string& type, const std::string& name,
+                            std::ostringstream& values, uint32_t count) {
+        if (count > 0) {
+            std::string body = values.str();
+            values.str("");
+            body.erase(body.find_last_not_of(" \n") + 1);
+            out << "static constexpr " << type << " " << name << "[] = {\n    " << indent(body, 4) << "\n};\n";
+        }
+    }
+
+    // the tables and a SceneTable called prefix + "Table" pointing at them, leaves the writer empty
+    void write(std::ostream& out, const std::string& prefix) {
+        write_array(out, "float", prefix + "Floats", floats, float_count);
+        write_array(out, "int", prefix + "Ints", ints, int_count);
+        write_array(out, "const char*", prefix + "Strings", strings, string_count);
+        write_array(out, "SceneFieldDescriptor", prefix + "Fields", fields, field_count);
+        write_array(out, "SceneAttributeDescriptor", prefix + "Attributes", attributes, attribute_count);
+        write_array(out, "SceneObjectDescriptor", prefix + "Objects", objects, object_count);
+        auto array = [&](const std::string& name, uint32_t count) {
+            return count > 0 ? prefix + name : std::string("nullptr");
+        };
+        out << "static constexpr SceneTable " << prefix << "Table = {" << array("Objects", object_count) << ", "
+            << object_count << ", " << array("Attributes", attribute_count) << ", " << array("Fields", field_count)
+            << ", " << array("Floats", float_count) << ", " << array("Ints", int_count) << ", "
+            << array("Strings", string_count) << "};\n";
+    }
+};
+
 struct JiccCompiler {
     std::string asset_path = "assets";
     std::string script_path = "scripts";
     std::string scene_path = "scenes";
+    std::string prefab_path = "prefabs";
     std::string proj;
     std::string build;
-    uint64_t var_count = 0;
+    // numbers the generated variables of one prefab or scene, which may be generated on any thread
+    inline static thread_local uint64_t var_count = 0;
     std::vector<std::string> sources;
+    std::vector<std::pair<std::string, std::string>> embedded; // .S stub, file it pulls in
     std::vector<Asset> assets;
-
-
-    JiccCompiler(const std::string& proj_path, const std::string& build_path) :
-        proj(proj_path), build(build_path) {
+    // content hash -> assets that own their bytes, to find duplicates
+    std::unordered_map<uint64_t, std::vector<size_t>> blobs;
+    uint64_t dedup_saved = 0;
+    std::vector<std::string> prefab_names;
+    bool pack_assets = false;
+    bool hot_reload = false;
+    bool validate_shaders = true;
+    bool strip_assets = false; // leave out assets nothing references
+    std::map<std::string, uint32_t> script_ids; // script location -> index in the generated script table
+    // strings scenes, prefabs, scripts and the splash screen could name an asset or shader program with
+    std::set<std::string> references;
+    bool precompiled_headers = true;
+    // scripts, prefabs and scenes compiled this many to a translation unit, 0 = one each
+    int unity_batch = 0;
+    // errors that should fail the build, main returns non-zero. Set from parallel_for jobs too.
+    std::atomic<bool> failed{false};
+    bool complete = false; // got as far as writing the manifest
+    Manifest& manifest;
+    ImportCache* imports; // only set by --watch
+    bool glslang_available = false;
+    // a file add_asset decided to write, asset is only there for --timings
+    struct Emit {
+        std::string asset;
+        std::function<void()> write;
+    };
+    std::vector<Emit> emits; // asset outputs add_asset decided on, written in parallel
+    std::mutex mutex; // sources, prefab_names and depends, which parallel_for jobs add to
+    // every file and directory the outputs are generated from, for --depfile. Directories are listed so
+    // adding or removing a file counts as a change.
+    std::set<std::string> depends;
+    // shader stem (asset path without the extension) -> its stages
+    std::map<std::string, std::vector<ShaderStage>> shader_stems;
+    std::vector<std::tuple<std::string, std::string, std::string>> shader_programs; // name, vertex, fragment
+    EmbedMode embed_mode = EmbedMode::Incbin;
+    SceneCodegen scene_codegen = SceneCodegen::Code;
+
+
+    JiccCompiler(const std::string& proj_path, const std::string& build_path, Manifest& manifest,
+                 ImportCache* imports = nullptr) :
+        proj(proj_path), build(build_path), manifest(manifest), imports(imports) {
         if (!fs::exists(proj)) {
             std::cerr << "Error: Project file not found" << std::endl;
             return;
         }
         if (!fs::exists(build)) {
             fs::create_directories(build);
-        } else {
-            fs::remove_all(build);
-            fs::create_directories(build);
+        }
+        timings.phase("project");
+        // the build folder is kept between runs, see Manifest
+        if (!manifest.loaded) {
+            manifest.load(fs::path(build) / "jicc_manifest.json");
         }
         std::cout << "Compiling project '" << proj << "' to '" << build << "'" << std::endl;
         fs::path json_path(proj);
@@ -220,33 +1237,63 @@ struct JiccCompiler {
             std::cerr << "Error: Project file not found" << std::endl;
             return;
         }
+        add_depend(json_path);
         std::ifstream json_file(json_path);
         if (!json_file.is_open()) {
             std::cerr << "Error: Failed to open project file" << std::endl;
             return;
         }
-        json j;
-        json_file >> j;
+        json j = json::parse(json_file, nullptr, false);
         json_file.close();
+        if (j.is_discarded()) {
+            std::cerr << "Error: Project file is not valid JSON" << std::endl;
+            failed = true;
+            return;
+        }
         parse_proj(j);
 
+        timings.phase("CMakeLists.txt");
+        // jobs add their sources in whatever order they finish
+        std::sort(sources.begin(), sources.end());
         // generate cmakelists for project
-        std::ofstream cml(fs::path(build) / "CMakeLists.txt");
-        cml << "cmake_minimum_required(VERSION 3.10)\n";
+        OutputFile cml(manifest, fs::path(build) / "CMakeLists.txt");
+        // 3.16 for precompiled headers and unity builds
+        cml << "cmake_minimum_required(VERSION 3.16)\n";
         cml << "project(game_build)\n";
         cml << "# version " << JICE_ENGINE_VERSION << "\n";
         cml << "set(CMAKE_CXX_STANDARD 17)\n\n";
-        cml << "add_executable(game ";
-        for (auto &src: sources) {
-            cml << cify_path(src) << " ";
+        if (!embedded.empty()) {
+            cml << "if(MSVC)\n";
+            cml << "    message(FATAL_ERROR \"Assets are embedded with .incbin, which MSVC does not support. "
+                   "Set content.embed_mode to \\\"hex\\\" in proj.json\")\n";
+            cml << "endif()\n";
+            cml << "enable_language(ASM)\n";
+            // .incbin is invisible to dependency scanning, so tell CMake about the embedded files
+            for (auto &[stub, file]: embedded) {
+                cml << "set_source_files_properties(\"" << cify_path(stub) << "\" PROPERTIES OBJECT_DEPENDS \""
+                    << file << "\")\n";
+            }
+            cml << "\n";
         }
-        cml << ")\n";
-        cml << "target_link_libraries(game Engine eogll)\n";
-        cml << "add_library(editor_import SHARED ";
+        // compiled once and linked into both the game and the editor's library
+        cml << "add_library(game_objects OBJECT ";
         for (auto &src: sources) {
             cml << cify_path(src) << " ";
         }
         cml << ")\n";
+        cml << "set_target_properties(game_objects PROPERTIES POSITION_INDEPENDENT_CODE ON)\n";
+        cml << "target_link_libraries(game_objects PUBLIC Engine eogll)\n";
+        if (precompiled_headers) {
+            // every script, prefab and scene pulls in the engine and its GL headers through this
+            cml << "target_precompile_headers(game_objects PRIVATE <Engine/Script.h>)\n";
+        }
+        if (unity_batch > 0) {
+            cml << "set_target_properties(game_objects PROPERTIES UNITY_BUILD ON UNITY_BUILD_BATCH_SIZE "
+                << unity_batch << ")\n";
+        }
+        cml << "add_executable(game $<TARGET_OBJECTS:game_objects>)\n";
+        cml << "target_link_libraries(game Engine eogll)\n";
+        cml << "add_library(editor_import SHARED $<TARGET_OBJECTS:game_objects>)\n";
         cml << "target_link_libraries(editor_import Engine eogll)\n";
         cml << "add_custom_command(TARGET game POST_BUILD COMMAND ${CMAKE_COMMAND} -E copy $<TARGET_FILE:game> \"";
         cml << cify_path(fs::path(build) / "out") << "\")\n";
@@ -259,95 +1306,693 @@ struct JiccCompiler {
         if (!fs::exists(fs::path(build) / "out")) {
             fs::create_directories(fs::path(build) / "out");
         }
+        if (!depfile.empty()) {
+            write_depfile();
+        }
+        write_outputs_list();
+        if (manifest.failed) {
+            failed = true;
+        }
+        size_t removed = 0;
+        if (failed) {
+            manifest.keep_stale();
+        } else {
+            removed = manifest.remove_stale();
+        }
+        manifest.save(fs::path(build) / "jicc_manifest.json");
+        std::cout << "OUTPUT: " << manifest.written << " written, " << manifest.unchanged << " unchanged, "
+                  << manifest.reused << " reused, " << removed << " removed" << std::endl;
+        timings.print();
+        complete = true;
     }
 
 private:
+    // one file under asset_path, imported on a parallel_for worker
+    struct AssetJob {
+        fs::path path;
+        fs::path rel_file;
+        std::string src;
+        AssetType type = AssetType::Compile;
+        TextureImport texture;
+        CompressionOptions compression;
+        std::map<std::string, std::vector<std::string>> variants;
+        // filled in by the worker
+        std::string file; // what ships
+        uint64_t hash = 0; // of file
+        bool ok = true;
+        bool shader = false;
+        ShaderStage stage;
+        bool keep = false; // "keep" in the .jmeta, for assets only scripts load by a computed name
+        Timings::Row timing;
+        std::vector<std::pair<fs::path, std::string>> made; // what import_asset produced on the way
+    };
+
     void parse_assets() {
-        // recurse through asset_path
+        timings.phase("assets: scan");
+        // sorted so deduplication picks the same owners and everything is emitted in the same order every run
+        std::vector<fs::path> paths;
+        add_depend(asset_path);
         for (const auto& entry: fs::recursive_directory_iterator(asset_path)) {
-            if (entry.is_regular_file()) {
-                std::string str = entry.path().string();
-                if (endswith(str, ".jmeta")) {
+            // .jmeta files included, as are the ones created below for assets without one
+            add_depend(entry.path());
+            if (entry.is_regular_file() && !endswith(entry.path().string(), ".jmeta")) {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+
+        std::vector<AssetJob> jobs;
+        for (auto& path: paths) {
+            AssetJob job;
+            job.path = path;
+            job.rel_file = fs::relative(path, fs::path(asset_path));
+            job.src = cify_path(path);
+            std::string& src = job.src;
+
+            if (fs::exists(src+".jmeta")) {
+                std::ifstream meta_file(src+".jmeta");
+                json j = json::parse(meta_file, nullptr, false);
+                meta_file.close();
+                if (j.is_discarded()) {
+                    // skipped, the failed run keeps what the last run made from it
+                    std::cerr << "Error: '" << src << ".jmeta' is not valid JSON" << std::endl;
+                    failed = true;
                     continue;
                 }
-                fs::path rel_root = fs::relative(entry.path().parent_path(), fs::path(asset_path));
-                fs::path rel_file = fs::relative(entry.path(), fs::path(asset_path));
-                std::string src = cify_path(entry.path());
-                AssetType type = AssetType::Compile; // TODO: determine default type
-
-                if (fs::exists(src+".jmeta")) {
-                    std::ifstream meta_file(src+".jmeta");
-                    json j;
-                    meta_file >> j;
-                    meta_file.close();
-                    j = verify_json(j, JsonID::Meta);
-                    if (j.contains("mode")) {
-                        if (j["mode"] == "copy") {
-                            type = AssetType::Copy;
-                        } else if (j["mode"] == "compile") {
-                            type = AssetType::Compile;
-                        } else {
-                            std::cout << "Warning: unknown mode, assuming compile" << std::endl;
-                        }
-                    }
-                } else {
-                    std::cout << "Warning: no meta file found, creating one (default = compile)" << std::endl;
-                    json dat = {
-                            {"engine_version", JICE_ENGINE_VERSION},
-                            {"data_id", (int)JsonID::Meta},
-                            {"data", {
-                                {"mode", "compile"}
-                            }}
-                    };
-                    std::ofstream meta_file(src+".jmeta");
-                    meta_file << dat.dump(4);
-                    meta_file.close();
+                j = verify_json(j, JsonID::Meta);
+                job.texture = parse_texture_import(j);
+                job.compression = parse_compression(j);
+                job.variants = parse_shader_variants(j);
+                if (j.contains("keep")) {
+                    job.keep = j["keep"];
                 }
-                if (type == AssetType::Compile) {
-                    std::cout << "ASSET: (compile) '" << rel_file.generic_string() << "'" << std::endl;
-                    std::string name = name_path(rel_file);
-                    fs::path dst = fs::path(build) / "assets" / rel_file;
-                    Asset asset = {type, name, cify_path(dst), cify_path(rel_file)};
-                    assets.push_back(asset);
-                    if (!fs::exists(dst.parent_path())) {
-                        fs::create_directories(dst.parent_path());
-                    }
-                    std::ifstream src_file(src);
-                    std::ofstream dst_file(cify_path(dst)+".h");
-                    dst_file << VERSION_CHECK_CPP;
-                    dst_file << "#pragma once\n";
-                    dst_file << "#include <cstdint>\n\n";
-                    dst_file << "const uint8_t " << name << "[" << std::filesystem::file_size(src) << "] = {\n";
-                    uint8_t byte;
-                    while (src_file.read((char*)&byte, 1)) {
-                        dst_file << "0x" << hex_num(byte) << ", ";
-                    }
-                    dst_file << "};\n";
-                    dst_file << "const size_t " << name << "_len = " << std::filesystem::file_size(src) << ";\n";
-                    src_file.close();
-                    dst_file.close();
-                } else if (type == AssetType::Copy) {
-                    std::cout << "ASSET: (copy) '" << rel_file.generic_string() << "'" << std::endl;
-                    fs::path dst = fs::path(build) / "out" / "assets" / rel_file;
-                    if (!fs::exists(dst.parent_path())) {
-                        fs::create_directories(dst.parent_path());
+                if (j.contains("mode")) {
+                    if (j["mode"] == "copy") {
+                        job.type = AssetType::Copy;
+                    } else if (j["mode"] == "compile") {
+                        job.type = AssetType::Compile;
+                    } else {
+                        std::cout << "Warning: unknown mode, assuming compile" << std::endl;
                     }
+                }
+            } else {
+                std::cout << "Warning: no meta file found, creating one (default = compile)" << std::endl;
+                json dat = {
+                        {"engine_version", JICE_ENGINE_VERSION},
+                        {"data_id", (int)JsonID::Meta},
+                        {"data", {
+                            {"mode", "compile"}
+                        }}
+                };
+                std::ofstream meta_file(src+".jmeta");
+                meta_file << dat.dump(4);
+                meta_file.close();
+                add_depend(src+".jmeta");
+            }
+            job.shader = is_shader(path);
+            jobs.push_back(job);
+        }
+        strip_unreferenced(jobs);
+        bool any_shader = std::any_of(jobs.begin(), jobs.end(), [](const AssetJob& job) { return job.shader; });
+        if (validate_shaders && any_shader) {
+            find_glslang();
+        }
+
+        timings.phase("assets: import");
+        // GL wants the bottom row first. stb keeps this in a global, so it's set here rather than per image.
+        stbi_set_flip_vertically_on_load(1);
+        // importing, compressing and hashing are independent per file
+        parallel_for(jobs.size(), [&](size_t i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            IoCount before = thread_io;
+            import_asset(jobs[i]);
+            jobs[i].timing = {cify_path(jobs[i].rel_file),
+                              std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+                              thread_io.read - before.read, thread_io.written - before.written};
+        });
+
+        timings.phase("assets: register");
+        for (auto& job: jobs) {
+            if (!job.ok) {
+                failed = true;
+                continue;
+            }
+            if (job.shader) {
+                std::string stem = cify_path(job.rel_file.parent_path() / job.rel_file.stem());
+                shader_stems[stem].push_back(job.stage);
+            }
+            add_asset(job.type, job.rel_file, job.file, job.hash);
+        }
+        pair_shader_variants();
+        if (dedup_saved > 0) {
+            std::cout << "DEDUP: " << dedup_saved << " bytes of duplicate assets are stored once" << std::endl;
+        }
+        timings.phase("assets: emit");
+        // every owner's header, stub or copy, decided above so only the writing is left
+        std::vector<Timings::Row> emitted(emits.size());
+        parallel_for(emits.size(), [&](size_t i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            IoCount before = thread_io;
+            emits[i].write();
+            emitted[i] = {emits[i].asset,
+                          std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+                          thread_io.read - before.read, thread_io.written - before.written};
+        });
+        emits.clear();
+
+        if (timings.enabled) {
+            std::map<std::string, Timings::Row> rows;
+            for (auto& job: jobs) {
+                rows[job.timing.name] = job.timing;
+            }
+            for (auto& row: emitted) {
+                Timings::Row& total = rows[row.name];
+                total.name = row.name;
+                total.ms += row.ms;
+                total.read += row.read;
+                total.written += row.written;
+            }
+            for (auto& [name, row]: rows) {
+                timings.assets.push_back(row);
+            }
+        }
+    }
 
-                    Asset asset = {type, name_path(rel_file), cify_path(dst), cify_path(rel_file)};
-                    assets.push_back(asset);
+    // files, scripts included, are only searched for strings, nothing is compiled
+    void collect_references(const json& dat) {
+        if (dat.contains("splash_screen") && dat["splash_screen"].contains("image")) {
+            collect_strings(dat["splash_screen"]["image"], references);
+        }
+        for (auto& dir: {scene_path, prefab_path, script_path}) {
+            if (!fs::exists(dir)) {
+                continue;
+            }
+            add_depend(dir);
+            for (const auto& entry: fs::recursive_directory_iterator(dir)) {
+                std::string file = cify_path(entry.path());
+                add_depend(entry.path());
+                if (endswith(file, ".json")) {
+                    count_read(fs::file_size(entry.path()));
+                    collect_strings(entry.path(), references);
+                } else if (endswith(file, ".cpp") || endswith(file, ".h") || endswith(file, ".hpp")) {
+                    std::vector<char> source = read_file(file);
+                    collect_string_literals(std::string(source.begin(), source.end()), references);
+                }
+            }
+        }
+        for (auto& [builtin, shader]: BUILTIN_SHADERS) {
+            if (references.count(builtin) != 0) {
+                references.insert(shader);
+            }
+        }
+    }
 
-                    if (fs::exists(dst)) {
-                        fs::remove(dst);
+    bool is_referenced(const AssetJob& job) const {
+        if (job.keep || references.count(cify_path(job.rel_file)) != 0) {
+            return true;
+        }
+        if (!job.shader) {
+            return false;
+        }
+        // a shader stage is used by its program, or any of the program's variants
+        std::string stem = cify_path(job.rel_file.parent_path() / job.rel_file.stem());
+        return std::any_of(references.begin(), references.end(), [&](const std::string& ref) {
+            return ref.compare(0, ref.find('@'), stem) == 0;
+        });
+    }
+
+    void strip_unreferenced(std::vector<AssetJob>& jobs) {
+        size_t count = 0;
+        uintmax_t bytes = 0;
+        for (auto& job: jobs) {
+            if (!is_referenced(job)) {
+                count++;
+                bytes += fs::file_size(job.path);
+                if (strip_assets) {
+                    std::cout << "ASSET: (stripped) '" << cify_path(job.rel_file) << "' is never referenced" << std::endl;
+                }
+            }
+        }
+        if (count == 0) {
+            return;
+        }
+        if (strip_assets) {
+            jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [&](const AssetJob& job) { return !is_referenced(job); }),
+                       jobs.end());
+            std::cout << "STRIP: " << count << " unreferenced assets left out, " << bytes << " bytes saved" << std::endl;
+        } else {
+            std::cout << "Note: " << count << " assets (" << bytes << " bytes) are never referenced, set "
+                      << "content.strip_assets to leave them out" << std::endl;
+        }
+    }
+
+    void import_asset(AssetJob& job) {
+        // shaders aren't cached, their includes can change without them
+        if (imports != nullptr && !job.shader && import_cached(job)) {
+            return;
+        }
+        const std::string& src = job.src;
+        const fs::path& rel_file = job.rel_file;
+        // the asset keeps its name, the runtime tells .jtex and .jcmp data apart by their magic
+        std::string file = src;
+        if (is_image(job.path) && job.texture.format != TextureFormat::Source) {
+            fs::path imported = fs::path(build) / "imported" / (rel_file.generic_string() + ".jtex");
+            std::string input = input_hash(src, std::to_string((int)job.texture.format) + ":" + std::to_string(job.texture.mipmaps));
+            if (manifest.fresh(imported, input)) {
+                file = cify_path(imported);
+                job.made.emplace_back(imported, input);
+            } else if (import_texture(manifest, src, imported, job.texture)) {
+                manifest.made_from(imported, input);
+                file = cify_path(imported);
+                job.made.emplace_back(imported, input);
+            }
+        }
+        if (job.shader && !process_shader(job.type, rel_file, src, job.variants, file, job.stage)) {
+            job.ok = false;
+            return;
+        }
+        // after the import, so compressed textures are still upload-ready once inflated
+        if (job.compression.codec != Compression::None) {
+            fs::path compressed = fs::path(build) / "compressed" / (rel_file.generic_string() + ".jcmp");
+            std::string input = input_hash(file, std::to_string((int)job.compression.codec) + ":" + std::to_string(job.compression.level));
+            if (manifest.fresh(compressed, input)) {
+                file = cify_path(compressed);
+                job.made.emplace_back(compressed, input);
+            } else if (compress_asset(manifest, file, compressed, job.compression)) {
+                manifest.made_from(compressed, input);
+                file = cify_path(compressed);
+                job.made.emplace_back(compressed, input);
+            }
+        }
+        job.file = file;
+        job.hash = fnv1a64(read_file(file));
+        if (imports != nullptr && !job.shader) {
+            std::error_code ec;
+            ImportCache::Entry entry = {fs::last_write_time(job.path, ec), fs::file_size(job.path, ec),
+                                        import_options(job), job.file, job.hash, job.made};
+            std::lock_guard<std::mutex> lock(imports->mutex);
+            imports->entries[job.src] = entry;
+        }
+    }
+
+    static std::string import_options(const AssetJob& job) {
+        return std::to_string((int)job.texture.format) + ":" + std::to_string(job.texture.mipmaps) + ":" +
+               std::to_string((int)job.compression.codec) + ":" + std::to_string(job.compression.level);
+    }
+
+    // true if the file is unchanged since the last regeneration, job is then filled in from the cache
+    bool import_cached(AssetJob& job) {
+        std::error_code ec;
+        ImportCache::Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(imports->mutex);
+            auto it = imports->entries.find(job.src);
+            if (it == imports->entries.end()) {
+                return false;
+            }
+            entry = it->second;
+        }
+        if (entry.mtime != fs::last_write_time(job.path, ec) || entry.size != fs::file_size(job.path, ec) ||
+            entry.options != import_options(job) || !fs::exists(entry.file)) {
+            return false;
+        }
+        for (auto& [output, input]: entry.made) {
+            manifest.made_from(output, input);
+        }
+        job.file = entry.file;
+        job.hash = entry.hash;
+        job.made = entry.made;
+        return true;
+    }
+
+    // Inlines #include "file" (relative to the including file, then to the asset folder). A file with
+    // #pragma once is only included the first time.
+    bool preprocess_shader(const fs::path& path, std::string& out, std::vector<fs::path>& stack,
+                           std::vector<fs::path>& once) {
+        fs::path canonical = fs::weakly_canonical(path);
+        if (std::find(once.begin(), once.end(), canonical) != once.end()) {
+            return true;
+        }
+        if (std::find(stack.begin(), stack.end(), canonical) != stack.end()) {
+            log_err() << "Error: '" << cify_path(path) << "' includes itself" << std::endl;
+            return false;
+        }
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            log_err() << "Error: could not open shader '" << cify_path(path) << "'" << std::endl;
+            return false;
+        }
+        stack.push_back(canonical);
+        std::string line;
+        int line_no = 0;
+        while (std::getline(in, line)) {
+            line_no++;
+            std::string trimmed = strip(line);
+            if (trimmed == "#pragma once") {
+                once.push_back(canonical);
+                continue;
+            }
+            if (trimmed.rfind("#include", 0) != 0) {
+                out += line + "\n";
+                continue;
+            }
+            size_t open = trimmed.find_first_of("\"<");
+            size_t close = open == std::string::npos ? open : trimmed.find_first_of("\">", open + 1);
+            if (close == std::string::npos) {
+                log_err() << "Error: " << cify_path(path) << ":" << line_no << ": malformed #include" << std::endl;
+                stack.pop_back();
+                return false;
+            }
+            std::string name = trimmed.substr(open + 1, close - open - 1);
+            fs::path target = path.parent_path() / name;
+            if (!fs::exists(target)) {
+                target = fs::path(asset_path) / name;
+            }
+            if (!fs::exists(target)) {
+                log_err() << "Error: " << cify_path(path) << ":" << line_no << ": cannot find include '" << name << "'" << std::endl;
+                stack.pop_back();
+                return false;
+            }
+            add_depend(target);
+            if (!preprocess_shader(target, out, stack, once)) {
+                stack.pop_back();
+                return false;
+            }
+        }
+        stack.pop_back();
+        return true;
+    }
+
+    // runs glslangValidator on a preprocessed stage, if it's installed
+    void find_glslang() {
+#ifdef _WIN32
+        const char* quiet = " > NUL 2>&1";
+#else
+        const char* quiet = " > /dev/null 2>&1";
+#endif
+        glslang_available = std::system((std::string("glslangValidator --version") + quiet).c_str()) == 0;
+        if (!glslang_available) {
+            std::cout << "Warning: glslangValidator not found, shaders are not validated" << std::endl;
+        }
+    }
+
+    bool validate_shader(const std::string& file, bool vertex) {
+        if (!validate_shaders || !glslang_available) {
+            return true;
+        }
+        // a stage that passed last run and hasn't changed since is not checked again
+        std::string input = input_hash(file, "validated");
+        if (manifest.fresh(file, input)) {
+            return true;
+        }
+        std::string cmd = std::string("glslangValidator -S ") + (vertex ? "vert" : "frag") + " \"" + file + "\"";
+        if (std::system(cmd.c_str()) != 0) {
+            log_err() << "Error: shader '" << file << "' failed validation" << std::endl;
+            return false;
+        }
+        manifest.made_from(file, input);
+        return true;
+    }
+
+    std::string write_shader(const fs::path& rel_file, const std::string& source) {
+        fs::path dst = fs::path(build) / "shaders" / rel_file;
+        manifest.write(dst, source);
+        return cify_path(dst);
+    }
+
+    fs::path variant_path(const fs::path& rel_file, const std::string& variant) {
+        // default.vert + fog -> default@fog.vert
+        return rel_file.parent_path() / (rel_file.stem().string() + "@" + variant + rel_file.extension().string());
+    }
+
+    // preprocesses and validates a stage and all of its variants, file becomes the base version
+    bool process_shader(AssetType type, const fs::path& rel_file, const std::string& src,
+                        const std::map<std::string, std::vector<std::string>>& variants, std::string& file,
+                        ShaderStage& stage) {
+        stage = {type, rel_file, "", {}};
+        std::vector<fs::path> stack, once;
+        if (!preprocess_shader(src, stage.base, stack, once)) {
+            return false;
+        }
+        bool vertex = is_vertex_shader(rel_file);
+        file = write_shader(rel_file, stage.base);
+        bool ok = validate_shader(file, vertex);
+        for (auto& [name, defines]: variants) {
+            fs::path rel_variant = variant_path(rel_file, name);
+            std::string variant_file = write_shader(rel_variant, add_defines(stage.base, defines));
+            ok = validate_shader(variant_file, vertex) && ok;
+            stage.variants[name] = variant_file;
+        }
+        return ok;
+    }
+
+    // Every variant either stage declares becomes a program. A stage that doesn't declare it gets its base
+    // source under the variant's name, deduplication turns that into an alias.
+    void pair_shader_variants() {
+        for (auto& [stem, stages]: shader_stems) {
+            std::vector<std::string> names = {""};
+            for (auto& stage: stages) {
+                for (auto& [name, file]: stage.variants) {
+                    if (std::find(names.begin(), names.end(), name) == names.end()) {
+                        names.push_back(name);
                     }
-                    fs::copy_file(src, dst, fs::copy_options::overwrite_existing);
-                } else {
-                    std::cerr << "Error: unknown asset type" << std::endl;
-                    std::cerr << "Should never happen" << std::endl;
                 }
             }
+            const ShaderStage* vert = nullptr;
+            const ShaderStage* frag = nullptr;
+            for (auto& stage: stages) {
+                (is_vertex_shader(stage.rel_file) ? vert : frag) = &stage;
+                for (size_t i = 1; i < names.size(); i++) {
+                    auto it = stage.variants.find(names[i]);
+                    std::string file = it != stage.variants.end() ? it->second
+                            : write_shader(variant_path(stage.rel_file, names[i]), stage.base);
+                    add_asset(stage.type, variant_path(stage.rel_file, names[i]), file, fnv1a64(read_file(file)));
+                }
+            }
+            if (vert == nullptr || frag == nullptr) {
+                continue; // a lone stage, nothing to link
+            }
+            for (auto& name: names) {
+                std::string program = name.empty() ? stem : stem + "@" + name;
+                std::string vert_name = cify_path(name.empty() ? vert->rel_file : variant_path(vert->rel_file, name));
+                std::string frag_name = cify_path(name.empty() ? frag->rel_file : variant_path(frag->rel_file, name));
+                shader_programs.emplace_back(program, vert_name, frag_name);
+                std::cout << "SHADER: '" << program << "'" << std::endl;
+            }
         }
     }
 
+    // Registers one asset under rel_file, shipping the bytes in file (whose content hash is hash). Writing
+    // its header / stub / copy is queued in emits.
+    void add_asset(AssetType type, const fs::path& rel_file, const std::string& file, uint64_t hash) {
+        // deduplicated on what ships, so assets that only match after the import still share
+        const Asset *owner = find_duplicate(type, hash, file);
+        if (owner != nullptr) {
+            // points at the owner's embedded symbol / copied file / pack entry, nothing new is written
+            std::cout << "ASSET: (shared) '" << rel_file.generic_string() << "' has the same bytes as '"
+                      << owner->src << "'" << std::endl;
+            Asset asset = {type, owner->name, owner->dst, cify_path(rel_file), file, owner->src};
+            dedup_saved += fs::file_size(file);
+            assets.push_back(asset);
+        } else if (type == AssetType::Compile) {
+            std::cout << "ASSET: (compile) '" << rel_file.generic_string() << "'" << std::endl;
+            std::string name = name_path(rel_file);
+            std::string dst = cify_path(fs::path(build) / "assets" / rel_file);
+            Asset asset = {type, name, dst, cify_path(rel_file), file};
+            add_blob(asset, hash);
+            if (embed_mode == EmbedMode::Incbin) {
+                sources.push_back(dst + ".S");
+                embedded.emplace_back(dst + ".S", cify_path(fs::absolute(file)));
+            }
+            emits.push_back({cify_path(rel_file), [this, name, file, dst]() {
+                embed_asset(name, file, dst);
+            }});
+        } else if (type == AssetType::Copy && pack_assets) {
+            // written out all at once by write_pack
+            std::cout << "ASSET: (pack) '" << rel_file.generic_string() << "'" << std::endl;
+            fs::path dst = fs::path(build) / "out" / "assets.jpak";
+            Asset asset = {type, name_path(rel_file), cify_path(dst), cify_path(rel_file), file};
+            add_blob(asset, hash);
+        } else if (type == AssetType::Copy) {
+            std::cout << "ASSET: (copy) '" << rel_file.generic_string() << "'" << std::endl;
+            fs::path dst = fs::path(build) / "out" / "assets" / rel_file;
+            Asset asset = {type, name_path(rel_file), cify_path(dst), cify_path(rel_file), file};
+            add_blob(asset, hash);
+            emits.push_back({cify_path(rel_file), [this, file, dst]() {
+                manifest.copy(file, dst);
+            }});
+        } else {
+            std::cerr << "Error: unknown asset type" << std::endl;
+            std::cerr << "Should never happen" << std::endl;
+        }
+    }
+
+    void add_blob(const Asset& asset, uint64_t hash) {
+        blobs[hash].push_back(assets.size());
+        assets.push_back(asset);
+    }
+
+    // an earlier asset of the same type that ships exactly these bytes
+    const Asset* find_duplicate(AssetType type, uint64_t hash, const std::string& file) {
+        auto it = blobs.find(hash);
+        if (it == blobs.end()) {
+            return nullptr;
+        }
+        std::vector<char> data = read_file(file);
+        for (size_t index: it->second) {
+            const Asset& candidate = assets[index];
+            // the hash only narrows it down, the bytes decide
+            if (candidate.type == type && fs::file_size(candidate.file) == data.size() && read_file(candidate.file) == data) {
+                return &candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    // Compiled assets are followed by a null byte that is not counted in their length, so text
+    // assets can be used as C strings straight from the executable.
+    void embed_asset(const std::string& name, const std::string& src, const std::string& dst) {
+        uintmax_t size = fs::file_size(src);
+        OutputFile header(manifest, dst + ".h");
+        header << VERSION_CHECK_CPP;
+        header << "#pragma once\n";
+        header << "#include <cstdint>\n";
+        header << "#include <cstddef>\n\n";
+
+        if (embed_mode == EmbedMode::Incbin) {
+            // the data is linked in as an object, the compiler only ever sees these two declarations
+            header << "extern \"C\" const uint8_t " << name << "[];\n";
+            header << "extern \"C\" const size_t " << name << "_len;\n";
+            header.close();
+
+            OutputFile stub(manifest, dst + ".S");
+            stub << "/* generated by jicc from " << cify_path(src) << " */\n";
+            stub << "#if defined(__APPLE__)\n";
+            stub << "#define SYM(x) _##x\n";
+            stub << "    .const_data\n";
+            stub << "#elif defined(_WIN32)\n";
+            stub << "#define SYM(x) x\n";
+            stub << "    .section .rdata,\"dr\"\n";
+            stub << "#else\n";
+            stub << "#define SYM(x) x\n";
+            stub << "    .section .rodata\n";
+            stub << "#endif\n";
+            stub << "    .global SYM(" << name << ")\n";
+            stub << "    .global SYM(" << name << "_len)\n";
+            stub << "    .balign 16\n";
+            stub << "SYM(" << name << "):\n";
+            stub << "    .incbin \"" << cify_path(fs::absolute(src)) << "\"\n";
+            stub << "    .byte 0\n";
+            stub << "    .balign 8\n";
+            stub << "SYM(" << name << "_len):\n";
+            stub << "#if __SIZEOF_POINTER__ == 8\n";
+            stub << "    .quad " << size << "\n";
+            stub << "#else\n";
+            stub << "    .long " << size << "\n";
+            stub << "#endif\n";
+            stub << "#if defined(__ELF__)\n";
+            stub << "    .section .note.GNU-stack,\"\",%progbits\n";
+            stub << "#endif\n";
+            stub.close();
+        } else {
+            std::vector<char> data(size);
+            count_read(size);
+            std::ifstream src_file(src, std::ios::binary);
+            src_file.read(data.data(), (std::streamsize)size);
+            src_file.close();
+            std::string text;
+            append_hex(text, data.data(), data.size());
+            header << "const uint8_t " << name << "[" << size + 1 << "] = {\n";
+            header << text << "0x00 };\n";
+            header << "const size_t " << name << "_len = " << size << ";\n";
+            header.close();
+        }
+    }
+
+    // packs every copy-mode asset into out/assets.jpak, see Engine/internal/AssetPack.h for the layout
+    void write_pack() {
+        struct PackEntry {
+            uint64_t hash;
+            std::string name;
+            std::string file;
+            std::string shares;
+            uint64_t size;
+            uint64_t offset;
+            uint32_t name_offset;
+        };
+        std::vector<PackEntry> entries;
+        for (auto &asset: assets) {
+            if (asset.type == AssetType::Copy) {
+                uint64_t size = fs::file_size(asset.file);
+                entries.push_back({fnv1a64(asset.src), asset.src, asset.file, asset.shares, size, 0, 0});
+            }
+        }
+        // the runtime binary searches by hash, names break ties so the output is deterministic
+        std::sort(entries.begin(), entries.end(), [](const PackEntry& a, const PackEntry& b) {
+            return a.hash != b.hash ? a.hash < b.hash : a.name < b.name;
+        });
+
+        const uint64_t align = 16; // JPAK_ALIGN
+        uint32_t names_size = 0;
+        for (auto &entry: entries) {
+            entry.name_offset = names_size;
+            names_size += (uint32_t)entry.name.size() + 1;
+        }
+        uint64_t offset = 16 + entries.size() * 32 + names_size;
+        std::unordered_map<std::string, uint64_t> owner_offsets;
+        for (auto &entry: entries) {
+            if (!entry.shares.empty()) {
+                continue;
+            }
+            offset = (offset + align - 1) / align * align;
+            entry.offset = offset;
+            owner_offsets[entry.name] = offset;
+            offset += entry.size;
+        }
+        // duplicates are just a second entry pointing at the same data
+        for (auto &entry: entries) {
+            if (!entry.shares.empty()) {
+                entry.offset = owner_offsets[entry.shares];
+            }
+        }
+
+        fs::path dst = fs::path(build) / "out" / "assets.jpak";
+        if (!fs::exists(dst.parent_path())) {
+            fs::create_directories(dst.parent_path());
+        }
+        OutputFile pack(manifest, dst);
+        write_raw<uint32_t>(pack, 0x4b41504a); // "JPAK"
+        write_raw<uint32_t>(pack, 1);
+        write_raw<uint32_t>(pack, (uint32_t)entries.size());
+        write_raw<uint32_t>(pack, names_size);
+        for (auto &entry: entries) {
+            write_raw<uint64_t>(pack, entry.hash);
+            write_raw<uint64_t>(pack, entry.offset);
+            write_raw<uint64_t>(pack, entry.size);
+            write_raw<uint32_t>(pack, 0); // flags
+            write_raw<uint32_t>(pack, entry.name_offset);
+        }
+        for (auto &entry: entries) {
+            pack.write(entry.name.c_str(), (std::streamsize)entry.name.size() + 1);
+        }
+        uint64_t pos = 16 + entries.size() * 32 + names_size;
+        std::vector<char> buffer;
+        for (auto &entry: entries) {
+            if (!entry.shares.empty()) {
+                continue;
+            }
+            write_padding(pack, pos, align);
+            buffer.resize(entry.size);
+            count_read(entry.size);
+            std::ifstream src_file(entry.file, std::ios::binary);
+            src_file.read(buffer.data(), (std::streamsize)entry.size);
+            pack.write(buffer.data(), (std::streamsize)entry.size);
+            pos += entry.size;
+        }
+        pack.close();
+        std::cout << "PACK: " << entries.size() << " assets, " << pos << " bytes" << std::endl;
+    }
+
     void parse_proj(json j) {
         std::ostringstream inc_sec;
         inc_sec << VERSION_CHECK_CPP;
@@ -356,6 +2001,7 @@ private:
         inc_sec += "#include <chrono>\n";
 #endif
         std::ostringstream src_main_sec;
+        std::ostringstream table_sec; // file scope, after the includes
 
         json dat = verify_json(j, JsonID::Project);
 
@@ -487,6 +2133,11 @@ private:
         src_main_sec << ", ";
         src_main_sec << '"' + con_auth_san + '"';
         src_main_sec << ");\n";
+        if (dat.find("texture_budget_mb") != dat.end()) {
+            // beyond this the least recently drawn textures are evicted, and reloaded when they're needed again
+            uint64_t budget = (uint64_t)((double)dat["texture_budget_mb"] * 1024 * 1024);
+            src_main_sec << "engine->textureBudget = " << budget << ";\n";
+        }
 
         json content;
         if (dat.find("content") == dat.end()) {
@@ -503,6 +2154,52 @@ private:
         if (content.find("scene_path") != content.end()) {
             scene_path = content["scene_path"];
         }
+        if (content.find("prefab_path") != content.end()) {
+            prefab_path = content["prefab_path"];
+        }
+        if (content.find("pack_assets") != content.end()) {
+            pack_assets = content["pack_assets"];
+        }
+        if (content.find("hot_reload") != content.end()) {
+            hot_reload = content["hot_reload"];
+            if (hot_reload && pack_assets) {
+                // packed assets have no files of their own to watch
+                std::cout << "Warning: hot_reload does nothing with pack_assets, only copy-mode files are watched" << std::endl;
+                hot_reload = false;
+            }
+        }
+        if (content.find("strip_assets") != content.end()) {
+            strip_assets = content["strip_assets"];
+        }
+        if (content.find("validate_shaders") != content.end()) {
+            validate_shaders = content["validate_shaders"];
+        }
+        if (content.find("precompiled_headers") != content.end()) {
+            precompiled_headers = content["precompiled_headers"];
+        }
+        if (content.find("unity_build") != content.end()) {
+            // true for a default batch size, or the number of sources per batch. Off by default, as
+            // scripts that define the same file-local names won't compile together.
+            if (content["unity_build"].is_boolean()) {
+                unity_batch = content["unity_build"] ? 16 : 0;
+            } else {
+                unity_batch = content["unity_build"];
+            }
+        }
+        if (content.find("embed_mode") != content.end()) {
+            if (content["embed_mode"] == "hex") {
+                embed_mode = EmbedMode::Hex;
+            } else if (content["embed_mode"] != "incbin") {
+                std::cout << "Warning: unknown embed_mode, assuming incbin" << std::endl;
+            }
+        }
+        if (content.find("scene_codegen") != content.end()) {
+            if (content["scene_codegen"] == "tables") {
+                scene_codegen = SceneCodegen::Tables;
+            } else if (content["scene_codegen"] != "code") {
+                std::cout << "Warning: unknown scene_codegen, assuming code" << std::endl;
+            }
+        }
         if (fs::path(asset_path).is_relative()) {
             asset_path = cify_path(fs::path(proj) / asset_path);
         }
@@ -512,6 +2209,9 @@ private:
         if (fs::path(scene_path).is_relative()) {
             scene_path = cify_path(fs::path(proj) / scene_path);
         }
+        if (fs::path(prefab_path).is_relative()) {
+            prefab_path = cify_path(fs::path(proj) / prefab_path);
+        }
 
         if (!fs::exists(asset_path)) {
             std::cerr << "Warning: Asset path not found" << std::endl;
@@ -523,11 +2223,18 @@ private:
             std::cerr << "Warning: Scene path not found" << std::endl;
         }
 
+        timings.phase("references");
+        collect_references(dat);
         parse_assets();
+        if (pack_assets) {
+            timings.phase("pack");
+            write_pack();
+        }
+        timings.phase("splash screen");
 
         bool splash_enabled = false;
 
-        if (content.find("splash_screen") != content.end()) {
+        if (dat.find("splash_screen") != dat.end()) {
             json splash = dat["splash_screen"];
             if (splash.find("enabled") != splash.end()) {
                 splash_enabled = splash["enabled"];
@@ -538,28 +2245,32 @@ private:
                 bool found = false;
                 Asset the_asset;
                 for (auto &asset: assets) {
-                    if (asset.type == AssetType::Compile && asset.name == name_path(img)) {
+                    if (asset.type == AssetType::Compile && asset.src == cify_path(img)) {
                         found = true;
                         the_asset = asset;
                         break;
                     }
                 }
                 if (!found) {
-                    std::cerr << "Error: Splash screen image not found in assets" << std::endl;
+                    // only a compiled asset can be shown before the rest are loaded
+                    std::cerr << "Error: Splash screen image not found in compiled assets" << std::endl;
                     splash_enabled = false;
+                    failed = true;
+                } else {
+                    // remove the_asset from assets
+                    assets.erase(std::remove(assets.begin(), assets.end(), the_asset), assets.end());
+
+                    src_main_sec << "// Splash enabled\n";
+                    std::string b = cify_path(fs::relative(the_asset.dst, fs::path(build)));
+                    std::string c = the_asset.src;
+                    inc_sec << "#include \"" + b + ".h\"\n";
+                    src_main_sec << "engine->addAsset(\"" + c + "\", CompiledAsset(" + the_asset.name + ", " + the_asset.name + "_len));\n";
+                    src_main_sec << "if (isCompiled) engine->beginSplash(\"" + cify_path(img) + "\");\n";
                 }
-                // remove the_asset from assets
-                assets.erase(std::remove(assets.begin(), assets.end(), the_asset), assets.end());
-
-                src_main_sec << "// Splash enabled\n";
-                std::string b = cify_path(fs::relative(the_asset.dst, fs::path(build)));
-                std::string c = the_asset.src;
-                inc_sec << "#include \"" + b + ".h\"\n";
-                src_main_sec << "engine->addAsset(\"" + c + "\", CompiledAsset(" + the_asset.name + ", " + the_asset.name + "_len));\n";
-                src_main_sec << "if (isCompiled) engine->beginSplash(\"" + cify_path(img) + "\");\n";
             } else if (splash_enabled) {
                 std::cerr << "Error: Splash screen enabled but no image specified" << std::endl;
                 splash_enabled = false;
+                failed = true;
             }
         }
 
@@ -574,13 +2285,57 @@ private:
             std::cerr << "Warning: Script path not found" << std::endl;
         }
 
+        timings.phase("scripts");
+        // generated in parallel, registered in a fixed order
+        std::sort(scripts.begin(), scripts.end());
+        parallel_for(scripts.size(), [&](size_t i) {
+            parse_script(scripts[i]);
+        });
+        std::vector<std::string> scr_paths;
         for (auto &script: scripts) {
-            parse_script(script);
             std::string scr_path = cify_path(fs::relative(fs::path(script), fs::path(script_path)));
             // turn the .cpp at the end to .h
             scr_path = scr_path.substr(0, scr_path.size() - 4);
             inc_sec << "#include \"scripts/" + scr_path + ".h\"\n";
-            src_main_sec << "engine->registerScript(\"" + scr_path + "\", " + dispatch_string(scr_path) + ");\n";
+            scr_paths.push_back(scr_path);
+        }
+        // an id is the script's index in the table, which the engine also binary searches by name
+        std::sort(scr_paths.begin(), scr_paths.end());
+        if (!scr_paths.empty()) {
+            table_sec << "static const ScriptDescriptor _ScriptTable[] = {\n";
+            for (auto &scr_path: scr_paths) {
+                script_ids[scr_path] = (uint32_t)script_ids.size();
+                table_sec << "    {\"" << scr_path << "\", " << dispatch_string(scr_path) << "},\n";
+            }
+            table_sec << "};\n";
+            src_main_sec << "engine->setScriptTable(_ScriptTable, " << scr_paths.size() << ");\n";
+        }
+
+        // prefabs are optional, so a missing prefab path is not worth a warning
+        std::vector<std::string> prefabs;
+        if (fs::exists(prefab_path)) {
+            for (const auto& entry: fs::recursive_directory_iterator(prefab_path)) {
+                if (endswith(entry.path().string(), ".json")) {
+                    prefabs.push_back(cify_path(entry.path()));
+                }
+            }
+        }
+
+        timings.phase("prefabs");
+        // before the scenes, which check their prefab references against prefab_names
+        std::sort(prefabs.begin(), prefabs.end());
+        std::vector<std::string> pf_names(prefabs.size());
+        parallel_for(prefabs.size(), [&](size_t i) {
+            pf_names[i] = parse_prefab(prefabs[i]);
+        });
+        for (auto &pf_name: pf_names) {
+            // like a scene, a prefab that failed fails the run and keeps its last outputs
+            if (pf_name.empty()) {
+                failed = true;
+                continue;
+            }
+            inc_sec << "#include \"prefabs/" + pf_name + ".h\"\n";
+            src_main_sec << "engine->addPrefab(\"" + pf_name + "\", new " + pf_name + "Prefab());\n";
         }
 
         std::vector<std::string> scenes;
@@ -594,8 +2349,19 @@ private:
             std::cerr << "Warning: Scene path not found" << std::endl;
         }
 
-        for (auto &scene: scenes) {
-            parse_scene(scene);
+        timings.phase("scenes");
+        std::sort(scenes.begin(), scenes.end());
+        // a scene that failed gets no include or addScene, the run fails instead of the game's build
+        std::vector<char> generated(scenes.size());
+        parallel_for(scenes.size(), [&](size_t i) {
+            generated[i] = parse_scene(scenes[i]);
+        });
+        for (size_t i = 0; i < scenes.size(); i++) {
+            if (!generated[i]) {
+                failed = true;
+                continue;
+            }
+            const std::string& scene = scenes[i];
             std::string scn_path = cify_path(fs::relative(fs::path(scene), fs::path(scene_path)));
             // turn the .json at the end to .h
             scn_path = scn_path.substr(0, scn_path.size() - 5);
@@ -603,27 +2369,62 @@ private:
             // if we detect a subdirectory, print error
             if (scn_path.find('/') != std::string::npos) {
                 std::cerr << "Error: Scene file in subdirectory" << std::endl;
+                failed = true;
                 continue;
             }
             inc_sec << "#include \"scenes/" + scn_path + ".h\"\n";
             src_main_sec << "engine->addScene(\"" + scn_path + "\", new " + scn_path + "(engine));\n";
         }
 
+        if (pack_assets) {
+            src_main_sec << "engine->addAssetPack(\"assets.jpak\");\n";
+        }
+        // descriptors only, an asset is not touched until the game first asks for it
+        std::vector<const Asset*> table;
         for (auto &asset: assets) {
-            if (asset.type == AssetType::Compile) {
+            if (asset.type == AssetType::Copy && pack_assets) {
+                continue;
+            }
+            if (asset.type == AssetType::Compile && asset.shares.empty()) {
                 std::string b = cify_path(fs::relative(fs::path(asset.dst), fs::path(build)));
-                std::string c = asset.src;
                 inc_sec << "#include \"" + b + ".h\"\n";
-                src_main_sec << "engine->addAsset(\"" + c + "\", CompiledAsset(" + asset.name + ", " + asset.name + "_len));\n";
-            } else if (asset.type == AssetType::Copy) {
-                src_main_sec << "engine->addAsset(\"" + asset.src + "\", CopiedAsset(\"" + asset.src + "\"));\n";
-            } else {
-                std::cerr << "Error: unknown asset type" << std::endl;
-                std::cerr << "Should never happen" << std::endl;
             }
+            table.push_back(&asset);
+        }
+        // the engine binary searches it
+        std::sort(table.begin(), table.end(), [](const Asset* a, const Asset* b) { return a->src < b->src; });
+        if (!table.empty()) {
+            table_sec << "static const AssetDescriptor _AssetTable[] = {\n";
+            for (auto asset: table) {
+                table_sec << "    {\"" << asset->src << "\", ";
+                if (!asset->shares.empty()) {
+                    table_sec << "nullptr, nullptr, nullptr, 0, \"" << asset->shares << "\"";
+                } else if (asset->type == AssetType::Compile) {
+                    table_sec << asset->name << ", &" << asset->name << "_len, nullptr, 0, nullptr";
+                } else {
+                    table_sec << "nullptr, nullptr, \"" << asset->src << "\", " << fs::file_size(asset->file) << ", nullptr";
+                }
+                table_sec << "},\n";
+            }
+            table_sec << "};\n";
+            src_main_sec << "engine->addAssetTable(_AssetTable, " << table.size() << ");\n";
+        }
+        if (!shader_programs.empty()) {
+            std::sort(shader_programs.begin(), shader_programs.end());
+            table_sec << "static const ShaderProgramDescriptor _ShaderTable[] = {\n";
+            for (auto& [program, vert, frag]: shader_programs) {
+                table_sec << "    {\"" << program << "\", \"" << vert << "\", \"" << frag << "\"},\n";
+            }
+            table_sec << "};\n";
+            src_main_sec << "engine->addShaderTable(_ShaderTable, " << shader_programs.size() << ");\n";
         }
 
+        if (hot_reload) {
+            src_main_sec << "engine->watchAssets(\"assets\");\n";
+        }
         src_main_sec << "engine->loadConfig(\"config.json\");\n";
+        // decode and upload the first scene's textures while the splash is still showing
+        src_main_sec << "engine->preload();\n";
         if (splash_enabled) {
             src_main_sec << "if (isCompiled) {\n";
 #ifdef SPLASH_DELAY
@@ -631,19 +2432,22 @@ private:
             src_main_sec << "    while (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - start).count() < 3) {}\n";
 #endif
             src_main_sec << "    engine->endSplash();\n";
+            src_main_sec << "}\n";
         }
 
         src_main_sec << "engine->run();\n";
         src_main_sec << "delete engine;\n";
         src_main_sec << "return 0;\n";
 
-        std::ofstream main_file(fs::path(build) / "main.cpp");
+        timings.phase("main.cpp");
+        OutputFile main_file(manifest, fs::path(build) / "main.cpp");
         main_file << "#ifdef _WIN32\n";
         main_file << "#define EXPORT __declspec(dllexport)\n";
         main_file << "#else\n";
         main_file << "#define EXPORT\n";
         main_file << "#endif\n";
         main_file << inc_sec.str();
+        main_file << "\n" << table_sec.str();
         main_file << "\n\nextern \"C\" EXPORT int mainGame(bool isCompiled) {\n    ";
         main_file << indent(src_main_sec.str(), 4);
         main_file << "\n}\n";
@@ -651,16 +2455,23 @@ private:
         main_file << "return mainGame(true);\n";
         main_file << "}\n";
         main_file.close();
+        // defines mainGame, which the editor's library needs as much as the game does
+        add_source(cify_path(fs::path(build) / "main.cpp"));
+
+    }
 
+    void add_source(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sources.push_back(path);
     }
 
     void parse_script(const std::string& scr_loc) {
         if (!fs::exists(scr_loc)) {
-            std::cerr << "Error: Script file not found" << std::endl;
+            log_err() << "Error: Script file not found" << std::endl;
             return;
         }
         fs::path file = fs::relative(fs::path(scr_loc), fs::path(script_path));
-        std::cout << "SCRIPT: '" << file.generic_string() << "'\n";
+        log_out() << "SCRIPT: '" << file.generic_string() << "'\n";
         fs::path out = fs::path(build) / "scripts" / file;
         file.replace_extension("");
         std::string outsrc = cify_path(file);
@@ -672,8 +2483,9 @@ private:
         if (!fs::exists(out.parent_path())) {
             fs::create_directories(out.parent_path());
         }
+        count_read(fs::file_size(scr_loc));
         std::ifstream scr_file(scr_loc);
-        std::ofstream out_file(out);
+        OutputFile out_file(manifest, out);
         out_file << VERSION_CHECK_CPP;
         out_file << "#include " << '"' << cify_path(out_h) << '"' << "\n";
         // put all contents of scr_loc into out_file
@@ -683,7 +2495,7 @@ private:
         out_file << "    return new " << outsrc << "(e, o);\n";
         out_file << "}\n";
         out_file.close();
-        sources.push_back(cify_path(out));
+        add_source(cify_path(out));
 
         out_file.open(out_h);
         out_file << "#pragma once\n";
@@ -691,9 +2503,122 @@ private:
         out_file << "#include <Engine/Script.h>\n";
         out_file << "ScriptInterface* " << dispatch_string(outsrc) << "(Engine* e, GameObject* o);\n";
         out_file.close();
-        sources.push_back(cify_path(out_h));
+        add_source(cify_path(out_h));
+    }
+    std::string parse_prefab(const std::string& pf_loc) {
+        fs::path rel_loc = fs::relative(fs::path(pf_loc), fs::path(prefab_path));
+        std::string pf_name = rel_loc.replace_extension("").generic_string();
+        log_out() << "PREFAB: '" << pf_name << "'\n";
+        // prefabs are not allowed to be in subdirectories, same as scenes
+        if (pf_name.find('/') != std::string::npos) {
+            log_err() << "Error: Prefab file in subdirectory" << std::endl;
+            return "";
+        }
+
+        count_read(fs::file_size(pf_loc));
+        std::ifstream pf_file(pf_loc);
+        json j = json::parse(pf_file, nullptr, false);
+        pf_file.close();
+        if (j.is_discarded()) {
+            log_err() << "Error: Prefab is not valid JSON" << std::endl;
+            return "";
+        }
+
+        json dat = verify_json(j, JsonID::Prefab);
+        if (dat.find("name") == dat.end()) {
+            log_err() << "Error: Prefab missing name" << std::endl;
+            return "";
+        }
+        if (dat["name"] != pf_name) {
+            log_err() << "Error: Prefab name mismatch" << std::endl;
+            return "";
+        }
+
+        std::ostringstream src_con_sec;
+        var_count = 0;
+        if (dat.find("attributes") != dat.end()) {
+            if (!dat["attributes"].is_array()) {
+                log_err() << "Error: Prefab attributes is not an array!" << std::endl;
+                return "";
+            }
+            for (auto& attr: dat["attributes"]) {
+                if (attr.find("type") == attr.end()) {
+                    log_err() << "Error: Attribute missing type" << std::endl;
+                    return "";
+                }
+                std::string attrd_id = "_AttributeData_" + std::to_string(var_count++);
+                src_con_sec << "AttributeData " << attrd_id << ";\n";
+                if (attr.find("data") != attr.end()) {
+                    if (!attr["data"].is_object()) {
+                        log_err() << "Error: Attribute data is not an object" << std::endl;
+                        return "";
+                    }
+                    size_t errors = error_count;
+                    src_con_sec << parse_attr_data(scene_fields(attr["data"]), attrd_id);
+                    if (error_count != errors) {
+                        return "";
+                    }
+                }
+                if (attr["type"] == "script") {
+                    if (attr.find("location") == attr.end()) {
+                        log_err() << "Error: Script attribute missing location" << std::endl;
+                        return "";
+                    }
+                    std::string location = attr["location"];
+                    int32_t script = script_id(location);
+                    if (script >= 0) {
+                        src_con_sec << "addScript(\"" << location << "\", " << script << "u, " << attrd_id << ");\n";
+                    } else {
+                        src_con_sec << "addScript(\"" << location << "\", " << attrd_id << ");\n";
+                    }
+                } else if (attr["type"] == "builtin") {
+                    if (attr.find("id") == attr.end()) {
+                        log_err() << "Error: Builtin attribute missing id" << std::endl;
+                        return "";
+                    }
+                    src_con_sec << "addBuiltin(\"" << std::string(attr["id"]) << "\", " << attrd_id << ");\n";
+                } else {
+                    log_err() << "Error: Unknown attribute type" << std::endl;
+                    return "";
+                }
+            }
+        }
+
+        if (!fs::exists(fs::path(build) / "prefabs")) {
+            fs::create_directories(fs::path(build) / "prefabs");
+        }
+        fs::path out = fs::path(build) / "prefabs" / (pf_name + ".cpp");
+        fs::path out_h = fs::path(build) / "prefabs" / (pf_name + ".h");
+        std::string class_name = pf_name + "Prefab";
+
+        OutputFile out_file(manifest, out);
+        out_file << VERSION_CHECK_CPP;
+        out_file << "#include \"" << pf_name << ".h\"\n";
+        out_file << '\n' << class_name << "::" << class_name << "() : Prefab(\"" << pf_name << "\") {\n    ";
+        out_file << indent(src_con_sec.str(), 4);
+        out_file << "}\n";
+        out_file.close();
+        add_source(cify_path(out));
+
+        out_file.open(out_h);
+        out_file << "#pragma once\n";
+        out_file << VERSION_CHECK_CPP;
+        out_file << "#include <Engine/internal/Prefab.h>\n";
+        out_file << "class " << class_name << " : public Prefab {\n";
+        out_file << "public:\n";
+        out_file << "    " << class_name << "();\n";
+        out_file << "};\n";
+        out_file.close();
+        add_source(cify_path(out_h));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        prefab_names.push_back(pf_name);
+        return pf_name;
     }
-    void parse_scene(const std::string& scn_loc) {
+
+    // false if the scene had errors, nothing is generated for it then
+    bool parse_scene(const std::string& scn_loc) {
+        size_t errors = error_count;
         std::ostringstream inc_sec;
         std::ostringstream src_con_sec;
         std::ostringstream src_set_sec;
@@ -702,17 +2627,12 @@ private:
 
         fs::path rel_loc = fs::relative(fs::path(scn_loc), fs::path(scene_path));
         std::string scene_name = rel_loc.replace_extension("").generic_string();
-        std::cout << "SCENE: '" << rel_loc.generic_string() << "'\n";
-
-        json j;
-        std::ifstream scn_file(scn_loc);
-        scn_file >> j;
-        scn_file.close();
+        log_out() << "SCENE: '" << rel_loc.generic_string() << "'\n";
 
         inc_sec << "#include \"" << cify_path(rel_loc.replace_extension(".h")) << "\"\n";
         if (!fs::exists(scn_loc)) {
-            std::cerr << "Error: Scene file not found" << std::endl;
-            return;
+            log_err() << "Error: Scene file not found" << std::endl;
+            return false;
         }
         if (!fs::exists(fs::path(build) / "scenes")) {
             fs::create_directories(fs::path(build) / "scenes");
@@ -722,52 +2642,87 @@ private:
         fs::path out_h = out;
         out_h.replace_extension(".h");
 
-        json dat = verify_json(j, JsonID::Scene);
-
-        if (dat.find("name") == dat.end()) {
-            std::cerr << "Error: Scene missing name" << std::endl;
-            return;
+        // Objects are generated as they are read, scenes can be far too big to hold as a JSON document.
+        // Their code is indented as it goes, so the constructor body is never copied whole.
+        std::string src_obj_sec;
+        SceneTableWriter table;
+        var_count = 0;
+        jice::SceneReader reader;
+        reader.onObject = [&](jice::SceneObject&& obj) {
+            if (scene_codegen == SceneCodegen::Tables) {
+                parse_object_table(obj, table, -1);
+            } else {
+                std::ostringstream obj_sec;
+                parse_object(obj, obj_sec, src_set_sec, src_upd_sec);
+                src_obj_sec += indent(obj_sec.str(), 4);
+            }
+        };
+        count_read(fs::file_size(scn_loc));
+        if (!reader.read(scn_loc)) {
+            log_err() << "Error: " << reader.error << std::endl;
+            return false;
         }
-        if (dat["name"] != scene_name) {
-            std::cerr << "Error: Scene name mismatch" << std::endl;
-            return;
+        // the checks verify_json makes, the reader only records what it saw
+        if (reader.engineVersion < 0) {
+            log_err() << "Error: JSON missing engine_version" << std::endl;
+            return false;
         }
-
-        src_con_sec << "this->name = \"" << scene_name << "\";\n";
-
-        if (dat.find("3d") == dat.end())
-            src_con_sec << "this->mode = SceneMode::Dimension2D;\n";
-        else {
-            if (dat["3d"])
-                src_con_sec << "this->mode = SceneMode::Dimension3D;\n";
-            else
-                src_con_sec << "this->mode = SceneMode::Dimension2D;\n";
+        if (reader.engineVersion != JICE_ENGINE_VERSION) {
+            log_err() << "Error: JSON engine_version mismatch" << std::endl;
+            return false;
+        }
+        if (reader.dataId < 0) {
+            log_err() << "Error: JSON missing data_id" << std::endl;
+            return false;
+        }
+        if (reader.dataId != (int)JsonID::Scene) {
+            log_err() << "Error: JSON data_id mismatch" << std::endl;
+            return false;
+        }
+        if (!reader.hasData) {
+            log_err() << "Error: JSON missing data" << std::endl;
+            return false;
+        }
+        if (!reader.hasName) {
+            log_err() << "Error: Scene missing name" << std::endl;
+            return false;
+        }
+        if (reader.name != scene_name) {
+            log_err() << "Error: Scene name mismatch" << std::endl;
+            return false;
         }
 
-        json content;
+        // objects that failed are left out, which would make a scene that quietly differs from its file
+        if (error_count != errors) {
+            return false;
+        }
 
-        if (dat.find("content") == dat.end())
-            content = {};
+        src_con_sec << "this->name = \"" << scene_name << "\";\n";
+        if (reader.is3d)
+            src_con_sec << "this->mode = SceneMode::Dimension3D;\n";
         else
-            content = dat["content"];
-
-        if (!content.is_array()) {
-            std::cerr << "Error: Scene content is not an array!" << std::endl;
-            return;
-        }
+            src_con_sec << "this->mode = SceneMode::Dimension2D;\n";
 
-        var_count = 0;
-        for (auto& obj: content) {
-            parse_object(obj, src_con_sec, src_set_sec, src_upd_sec);
+        std::ostringstream src_tail_sec;
+        std::string table_prefix = "_" + scene_name + "_";
+        if (table.object_count > 0) {
+            src_tail_sec << "addObjects(" << table_prefix << "Table);\n";
         }
 
         src_set_sec << "Scene::Setup();\n";
         src_upd_sec << "Scene::Update();\n";
 
-        std::ofstream out_file(out);
+        OutputFile out_file(manifest, out);
         out_file << inc_sec.str();
+        if (table.object_count > 0) {
+            out_file << '\n';
+            table.write(out_file, table_prefix);
+        }
         out_file << '\n' << scene_name << "::" << scene_name << "(Engine* e) : Scene(e) {\n    ";
         out_file << indent(src_con_sec.str(), 4);
+        out_file << src_obj_sec;
+        std::string().swap(src_obj_sec);
+        out_file << indent(src_tail_sec.str(), 4);
         out_file << "}\n\n";
         out_file << "void " << scene_name << "::Setup() {\n    ";
         out_file << indent(src_set_sec.str(), 4);
@@ -776,7 +2731,7 @@ private:
         out_file << indent(src_upd_sec.str(), 4);
         out_file << "}\n";
         out_file.close();
-        sources.push_back(cify_path(out));
+        add_source(cify_path(out));
 
         out_file.open(out_h);
         out_file << "#pragma once\n";
@@ -790,91 +2745,195 @@ private:
         out_file << "    void Update() override;\n";
         out_file << "};\n";
         out_file.close();
-        sources.push_back(cify_path(out_h));
+        add_source(cify_path(out_h));
+        return true;
     }
 
-    std::string parse_object(json obj, std::ostringstream& src_con_sec, std::ostringstream& src_set_sec, std::ostringstream& src_upd_sec, bool child=false) {
-        if (obj.find("id") == obj.end()) {
-            std::cerr << "Error: Object missing id" << std::endl;
-            return "";
+    void add_depend(const fs::path& path) {
+        std::string file = cify_path(fs::absolute(path));
+        std::lock_guard<std::mutex> lock(mutex);
+        depends.insert(file);
+    }
+
+    // Makefile syntax, which both Ninja and Make read: build/jicc.stamp depends on everything in depends.
+    // main touches the stamp after every successful run.
+    void write_depfile() {
+        auto escape = [](const std::string& path) {
+            std::string out;
+            for (char c: path) {
+                if (c == ' ' || c == '#') {
+                    out += '\\';
+                } else if (c == '$') {
+                    out += '$';
+                }
+                out += c;
+            }
+            return out;
+        };
+        OutputFile out(manifest, depfile);
+        out << escape(cify_path(fs::absolute(fs::path(build) / "jicc.stamp"))) << ":";
+        for (auto& file: depends) {
+            out << " \\\n  " << escape(file);
+        }
+        out << "\n";
+        out.close();
+    }
+
+    // Everything this run generated, for jice_compile to declare as BYPRODUCTS of the build-time run, so
+    // Ninja checks them again after jicc rewrote them. CMakeLists.txt is left out, CMake itself tracks it.
+    void write_outputs_list() {
+        fs::path list_path = fs::path(build) / "jicc_outputs.txt";
+        std::string list_key = manifest.key(list_path);
+        std::string cml_key = manifest.key(fs::path(build) / "CMakeLists.txt");
+        std::string dep_key = depfile.empty() ? "" : manifest.key(depfile);
+        OutputFile out(manifest, list_path);
+        for (auto& key: manifest.outputs) {
+            if (key == list_key || key == cml_key || key == dep_key) {
+                continue;
+            }
+            fs::path file = manifest.resolve(key);
+            if (!file.empty()) {
+                out << cify_path(file) << "\n";
+            }
         }
+        out.close();
+    }
+
+    // the id a script was given in the script table, -1 for one that doesn't exist, which fails the build
+    int32_t script_id(const std::string& location) {
+        auto it = script_ids.find(location);
+        if (it == script_ids.end()) {
+            log_err() << "Error: Unknown script '" << location << "'" << std::endl;
+            failed = true;
+            return -1;
+        }
+        return (int32_t)it->second;
+    }
+
+    static std::string sanitize_object_id(const std::string& obj_id) {
         // same as main id sanitization
-        std::string obj_id = obj["id"];
         std::string obj_id_san;
         for (char c: obj_id) {
-            if (obj_id_san.empty()) {
-                if (std::isalnum(c) || c == '_') {
-                    obj_id_san += c;
-                } else {
-                    std::cout << "Warning: Object id contains invalid characters, removing" << std::endl;
-                }
+            if (std::isalnum(c) || c == '_') {
+                obj_id_san += c;
             } else {
-                if (std::isalnum(c) || c == '_') {
-                    obj_id_san += c;
-                } else {
-                    std::cout << "Warning: Object id contains invalid characters, removing" << std::endl;
-                }
+                log_out() << "Warning: Object id contains invalid characters, removing" << std::endl;
             }
         }
         if (obj_id_san.empty()) {
             obj_id_san = "object";
-            std::cout << "Warning: Object id is empty, using 'object'" << std::endl;
+            log_out() << "Warning: Object id is empty, using 'object'" << std::endl;
         }
+        return obj_id_san;
+    }
 
-        std::string go_id = "_GameObject_p_" + std::to_string(var_count++);
+    // checks what the scene reader leaves to its users
+    static bool verify_object(const jice::SceneObject& obj) {
+        if (!obj.hasId) {
+            log_err() << "Error: Object missing id" << std::endl;
+            return false;
+        }
+        for (auto& attr: obj.attributes) {
+            if (attr.type.empty()) {
+                log_err() << "Error: Attribute missing type" << std::endl;
+                return false;
+            } else if (attr.type == "script" && attr.location.empty()) {
+                log_err() << "Error: Script attribute missing location" << std::endl;
+                return false;
+            } else if (attr.type == "builtin" && attr.id.empty()) {
+                log_err() << "Error: Builtin attribute missing id" << std::endl;
+                return false;
+            } else if (attr.type != "script" && attr.type != "builtin") {
+                log_err() << "Error: Unknown attribute type" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
 
-        src_con_sec << "auto* " << go_id << " = new GameObject(\"" << obj_id_san << "\");\n";
-        if (obj.find("attributes") != obj.end()) {
-            if (!obj["attributes"].is_array()) {
-                std::cerr << "Error: Object attributes is not an array!" << std::endl;
-                return "";
+    // parse_object for SceneCodegen::Tables, the object and its children are appended to table
+    void parse_object_table(const jice::SceneObject& obj, SceneTableWriter& table, int32_t parent) {
+        if (!verify_object(obj)) {
+            return;
+        }
+        std::string obj_id_san = sanitize_object_id(obj.id);
+        if (!obj.prefab.empty() &&
+            std::find(prefab_names.begin(), prefab_names.end(), obj.prefab) == prefab_names.end()) {
+            log_err() << "Error: Unknown prefab '" << obj.prefab << "'" << std::endl;
+            return;
+        }
+
+        int32_t index = (int32_t)table.object_count;
+        uint32_t first = table.begin_object(obj_id_san, obj.prefab, parent);
+        if (!obj.prefab.empty()) {
+            for (auto& [attr_id, attr_data]: obj.overrides) {
+                table.add_attribute("Override", attr_id, -1, attr_data);
             }
-            for (auto& attr: obj["attributes"]) {
-                if (attr.find("type") == attr.end()) {
-                    std::cerr << "Error: Attribute missing type" << std::endl;
-                    return "";
-                }
-                std::string attrd_id = "_AttributeData_" + std::to_string(var_count++);
-                src_con_sec << "AttributeData " << attrd_id << ";\n";
-                if (attr["type"] == "script") {
-                    if (attr.find("location") == attr.end()) {
-                        std::cerr << "Error: Script attribute missing location" << std::endl;
-                        return "";
-                    }
-                    src_con_sec << go_id << "->addAttribute(new Attribute(e->dispatchScript(\""
-                        << std::string(attr["location"]) << "\", " << go_id << "), " << attrd_id << ", \""
-                        << std::string(attr["location"]) << "\"));\n";
-                } else if (attr["type"] == "builtin") {
-                    if (attr.find("id") == attr.end()) {
-                        std::cerr << "Error: Builtin attribute missing id" << std::endl;
-                        return "";
-                    }
-                    if (attr.find("data") != attr.end()) {
-                        src_con_sec << parse_attr_data(attr["data"], attrd_id);
-                    }
-                    src_con_sec << go_id << "->addAttribute(new Attribute(e, \"" << std::string(attr["id"]) << "\", " << attrd_id << "));\n";
-                } else {
-                    std::cerr << "Error: Unknown attribute type" << std::endl;
-                    return "";
-                }
+        }
+        for (auto& attr: obj.attributes) {
+            if (attr.type == "script") {
+                // like the code mode, scene scripts get no data
+                table.add_attribute("Script", attr.location, script_id(attr.location));
+            } else {
+                table.add_attribute("Builtin", attr.id, -1, attr.data);
             }
         }
+        table.end_object(first);
+        for (auto& child: obj.children) {
+            parse_object_table(child, table, index);
+        }
+    }
+
+    std::string parse_object(const jice::SceneObject& obj, std::ostringstream& src_con_sec, std::ostringstream& src_set_sec, std::ostringstream& src_upd_sec, bool child=false) {
+        if (!verify_object(obj)) {
+            return "";
+        }
+        std::string obj_id_san = sanitize_object_id(obj.id);
 
-        if (obj.find("children") != obj.end()) {
-            if (!obj["children"].is_array()) {
-                std::cerr << "Error: Object children is not an array!" << std::endl;
+        std::string go_id = "_GameObject_p_" + std::to_string(var_count++);
+
+        if (!obj.prefab.empty()) {
+            // only the overridden fields are emitted, the prefab holds the shared defaults
+            const std::string& pf_name = obj.prefab;
+            if (std::find(prefab_names.begin(), prefab_names.end(), pf_name) == prefab_names.end()) {
+                log_err() << "Error: Unknown prefab '" << pf_name << "'" << std::endl;
                 return "";
             }
-            for (auto& child: obj["children"]) {
-                std::string cid = parse_object(child, src_con_sec, src_set_sec, src_upd_sec, true);
-                src_con_sec << go_id << "->addObject(" << cid << ");\n";
+            std::string over_id = "_PrefabOverrides_" + std::to_string(var_count++);
+            src_con_sec << "PrefabOverrides " << over_id << ";\n";
+            for (auto& [attr_id, attr_data]: obj.overrides) {
+                src_con_sec << parse_attr_data(attr_data, over_id + "[\"" + attr_id + "\"]");
             }
-
-            if (!child) {
-                src_con_sec << "this->addObject(" << go_id << ");\n";
+            src_con_sec << "auto* " << go_id << " = e->instantiate(\"" << pf_name << "\", \"" << obj_id_san << "\", "
+                << over_id << ");\n";
+        } else {
+            src_con_sec << "auto* " << go_id << " = new GameObject(\"" << obj_id_san << "\");\n";
+        }
+        for (auto& attr: obj.attributes) {
+            std::string attrd_id = "_AttributeData_" + std::to_string(var_count++);
+            src_con_sec << "AttributeData " << attrd_id << ";\n";
+            if (attr.type == "script") {
+                int32_t script = script_id(attr.location);
+                src_con_sec << go_id << "->addAttribute(new Attribute(e->dispatchScript(";
+                if (script >= 0) {
+                    src_con_sec << script << "u";
+                } else {
+                    src_con_sec << "\"" << attr.location << "\"";
+                }
+                src_con_sec << ", " << go_id << "), " << attrd_id << ", \"" << attr.location << "\"));\n";
+            } else {
+                src_con_sec << parse_attr_data(attr.data, attrd_id);
+                src_con_sec << go_id << "->addAttribute(new Attribute(e, \"" << attr.id << "\", " << attrd_id << "));\n";
             }
+        }
 
+        for (auto& child: obj.children) {
+            std::string cid = parse_object(child, src_con_sec, src_set_sec, src_upd_sec, true);
+            src_con_sec << go_id << "->addObject(" << cid << ");\n";
+        }
 
+        if (!child) {
+            src_con_sec << "this->addObject(" << go_id << ");\n";
         }
 
         return go_id;
@@ -883,15 +2942,171 @@ private:
 
 };
 
+// --watch: tells every client connected to build/jicc.sock when a regeneration is done, one line each
+struct WatchSocket {
+    int fd = -1;
+    std::string path;
+    std::vector<int> clients;
+
+#if defined(__linux__)
+    bool open(const fs::path& socket_path) {
+        path = cify_path(socket_path);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Warning: '" << path << "' is too long for a socket, not notifying clients" << std::endl;
+            return false;
+        }
+        std::copy(path.begin(), path.end(), addr.sun_path);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        // left behind by a jicc that was killed
+        unlink(path.c_str());
+        if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+            std::cerr << "Warning: failed to listen on '" << path << "', not notifying clients" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void accept_clients() {
+        if (fd < 0) {
+            return;
+        }
+        for (int client; (client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC)) >= 0;) {
+            clients.push_back(client);
+        }
+    }
+
+    void send(const std::string& line) {
+        std::string data = line + "\n";
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (::send(*it, data.data(), data.size(), MSG_NOSIGNAL) != (ssize_t)data.size()) {
+                close(*it); // disconnected
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    ~WatchSocket() {
+        for (int client: clients) {
+            close(client);
+        }
+        if (fd >= 0) {
+            close(fd);
+            unlink(path.c_str());
+        }
+    }
+#else
+    bool open(const fs::path& socket_path) {
+        std::cerr << "Warning: notifying clients is only supported on Linux" << std::endl;
+        return false;
+    }
+
+    void accept_clients() {}
+
+    void send(const std::string& line) {}
+#endif
+};
+
+// Regenerates whenever a file in the project changes, until killed. Everything a run learns is kept
+// in memory, so the next one only imports the assets that changed and recognizes unchanged outputs
+// without reading them back.
+int watch(const std::string& proj, const std::string& build) {
+    Manifest manifest;
+    manifest.remember = true;
+    ImportCache imports;
+    jice::FileWatcher watcher;
+    if (!watcher.watch(proj)) {
+        return 1;
+    }
+    std::error_code ec;
+    fs::create_directories(build, ec);
+    WatchSocket socket;
+    socket.open(fs::path(build) / "jicc.sock");
+    // jicc's own outputs must not trigger another run
+    fs::path build_rel = fs::relative(fs::weakly_canonical(build), fs::weakly_canonical(proj), ec);
+    std::string ignored = build_rel.empty() || *build_rel.begin() == ".." ? "" : build_rel.generic_string() + "/";
+
+    using clock = std::chrono::steady_clock;
+    bool dirty = true;
+    clock::time_point last_change;
+    while (true) {
+        socket.accept_clients();
+        for (auto& rel: watcher.poll()) {
+            std::string name = fs::path(rel).filename().string();
+            // editor swap and backup files
+            if ((!ignored.empty() && rel.rfind(ignored, 0) == 0) || name.empty() || name[0] == '.' ||
+                name.back() == '~') {
+                continue;
+            }
+            dirty = true;
+            last_change = clock::now();
+        }
+        // saves tend to come in bursts, wait for them to settle
+        if (dirty && clock::now() - last_change >= std::chrono::milliseconds(50)) {
+            dirty = false;
+            auto start = clock::now();
+            timings.phases.clear();
+            timings.assets.clear();
+            JiccCompiler jicc(proj, build, manifest, &imports);
+            double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(1);
+            if (jicc.complete && !jicc.failed) {
+                line << "done " << ms << " " << manifest.written;
+            } else {
+                line << "failed " << ms;
+            }
+            manifest.next_run(jicc.complete);
+            std::cout << "WATCH: " << line.str() << std::endl;
+            socket.send(line.str());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "JICC Compiler v2" << std::endl;
 //    JiccCompiler jicc("C:/Users/wyatt/Desktop/structure/projects/testproject/", "C:/Users/wyatt/Desktop/structure/projects/testproject/build/");
     // compile from args
     if (argc < 3) {
-        std::cerr << "Usage: jicc <project_path> <build_path>" << std::endl;
+        std::cerr << "Usage: jicc <project_path> <build_path> [-j threads] [--timings] [--watch] [--depfile file]"
+                  << std::endl;
         return 1;
     }
-    JiccCompiler jicc(argv[1], argv[2]);
-
+    bool watching = false;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--timings") {
+            timings.enabled = true;
+        } else if (arg == "--watch") {
+            watching = true;
+        } else if (arg == "--depfile" && i + 1 < argc) {
+            depfile = argv[++i];
+        } else if (arg == "-j" && i + 1 < argc) {
+            job_threads = (unsigned int)std::stoul(argv[++i]);
+        } else if (arg.rfind("-j", 0) == 0 && arg.size() > 2) {
+            job_threads = (unsigned int)std::stoul(arg.substr(2));
+        } else {
+            std::cerr << "Warning: unknown argument '" << arg << "'" << std::endl;
+        }
+    }
+    if (watching) {
+        return watch(argv[1], argv[2]);
+    }
+    Manifest manifest;
+    JiccCompiler jicc(argv[1], argv[2], manifest);
+    if (jicc.failed || !jicc.complete) {
+        return 1;
+    }
+    if (!depfile.empty()) {
+        // newer than everything in the depfile, whether or not this run had to change any output
+        fs::path stamp = fs::path(argv[2]) / "jicc.stamp";
+        std::ofstream(stamp).close();
+        std::error_code ec;
+        fs::last_write_time(stamp, fs::file_time_type::clock::now(), ec);
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -8,4 +8,7 @@ uniform sampler2D tex;
 
 void main() {
     color = texture(tex, TexCoord);
+#ifdef TINT
+    color *= TINT_COLOR;
+#endif
 }